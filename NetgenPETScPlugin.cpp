@@ -2,17 +2,23 @@
 #include "MeshAlgorithm.hpp"
 #include "FvmMesh.hpp"
 #include "FvmMaterial.hpp"
+#include "FvmMaterialTable.hpp"
 #include "FvmMeshToVtk.hpp"
+#include "FvmParam.hpp"
 
 #include "argparse/argparse.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include <petscdm.h>
 #include <petscsys.h>
 #include <petscviewer.h>
 
 
+#include "BndCond.hpp"
 #include "FvmSetup.hpp"
 #include "FvmSimulation.hpp"
 #include "FvmVar.hpp"
@@ -31,10 +37,49 @@ int main(const int argc, char *argv[]) {
 			.help("STEP CAD file (.stp .step .STP .STEP)")
 			.metavar("STEP_FILE");
 
+	program.add_argument("--distributed")
+			.help("build the FVM mesh partition-wise on every rank instead of globally on rank 0")
+			.default_value(false)
+			.implicit_value(true);
+
+	program.add_argument("--mesh-cache")
+			.help("directory of the binary FVM mesh cache; skips meshing when STEP file and mesh settings are unchanged")
+			.metavar("DIR")
+			.default_value(std::string());
+
+	program.add_argument("--renumber")
+			.help("cell renumbering after the FVM mesh build: none, rcm or hilbert")
+			.default_value(std::string("none"))
+			.choices("none", "rcm", "hilbert");
+
+	program.add_argument("--threads")
+			.help("threads of the mesh geometry loops (0: all hardware threads on one rank, 1 per rank under MPI)")
+			.metavar("N")
+			.default_value(0)
+			.scan<'i', int>();
+
+	program.add_argument("--mesh-only")
+			.help("stop after building the FVM mesh, without running the solver")
+			.default_value(false)
+			.implicit_value(true);
+
+	program.add_argument("--results")
+			.help("directory of the results and residuals files of the solver")
+			.metavar("DIR")
+			.default_value(std::string("."));
+
+	program.add_argument("--coupled")
+			.help("solve velocity and pressure as one block system (fieldsplit preconditioner) instead of SIMPLE/PISO")
+			.default_value(false)
+			.implicit_value(true);
+
 	program.add_epilog("Done by: Paweł Gilewicz");
 
+	// Options argparse does not know (-p_ksp_type cg, -log_view, ...) go to PETSc; they follow
+	// STEP_FILE, so that their values are not taken for it
+	std::vector<std::string> petscArgs;
 	try {
-		program.parse_args(argc, argv);
+		petscArgs = program.parse_known_args(argc, argv);
 	} catch (const std::exception &err) {
 		std::cerr << err.what() << std::endl;
 		std::cerr << program;
@@ -42,9 +87,24 @@ int main(const int argc, char *argv[]) {
 	}
 
 	const auto stepFile = program.get<std::string>("stepFile");
-
-	int petscArgc = argc;
-	char **petscArgv = argv;
+	const bool distributed = program.get<bool>("--distributed");
+	const auto meshCacheDir = program.get<std::string>("--mesh-cache");
+	const bool solve = !program.get<bool>("--mesh-only");
+	const auto resultsDir = program.get<std::string>("--results");
+
+	const auto renumber = program.get<std::string>("--renumber");
+	fvmParameter.renumber = renumber == "rcm" ? 1 : renumber == "hilbert" ? 2 : 0;
+	fvmParameter.coupled = program.get<bool>("--coupled") ? LOGICAL_TRUE : LOGICAL_FALSE;
+	fvmParameter.nthreads = std::max(0, program.get<int>("--threads"));
+
+	petscArgs.insert(petscArgs.begin(), argv[0]);
+	std::vector<char *> petscArgvStorage;
+	for (auto &arg: petscArgs)
+		petscArgvStorage.push_back(arg.data());
+	petscArgvStorage.push_back(nullptr);
+
+	int petscArgc = static_cast<int>(petscArgs.size());
+	char **petscArgv = petscArgvStorage.data();
 	static char help[] =
 			"Three-dimensional unstructured finite-volume implicit flow solver.\n";
 
@@ -63,51 +123,87 @@ int main(const int argc, char *argv[]) {
 	PetscPrintf(PETSC_COMM_WORLD, "\n");
 
 	const auto fvmSimulation = std::make_unique<FvmSimulation>();
-	fvmSimulation->GenerateMesh(stepFile);
-	fvmSimulation->DecomposeMesh();
 
-	if (fvmSimulation->ConstructGlobalFvmMesh() == LOGICAL_ERROR) {
-		exit(LOGICAL_ERROR);
+	// The cache holds the global mesh; the distributed build always meshes
+	const bool useMeshCache = !distributed && !meshCacheDir.empty();
+	const bool meshCached = useMeshCache && fvmSimulation->LoadFvmMeshCache(stepFile, meshCacheDir);
+
+	if (!meshCached) {
+		fvmSimulation->GenerateMesh(stepFile);
+		fvmSimulation->DecomposeMesh();
+	}
+
+	if (distributed) {
+		if (fvmSimulation->ConstructDistributedFvmMesh() == LOGICAL_ERROR) {
+			exit(LOGICAL_ERROR);
+		}
+	} else {
+		if (!meshCached) {
+			if (fvmSimulation->ConstructGlobalFvmMesh() == LOGICAL_ERROR) {
+				exit(LOGICAL_ERROR);
+			}
+
+			if (useMeshCache)
+				fvmSimulation->SaveFvmMeshCache();
+		}
+
+		fvmSimulation->ExportMeshPartitions();
+	}
+
+	if (solve) {
+		const auto fvmMesh = fvmSimulation->GetFvmMesh();
+
+		// The global mesh lives on rank 0 only: the solver needs every rank to hold its partition
+		if (!distributed && processorsNb > 1) {
+			PetscPrintf(PETSC_COMM_WORLD, "\nThe solver runs on one rank or with --distributed; skipping the solve\n");
+		} else {
+			const std::string materialsPath = std::string(ASSETS_DIR) + "/materials.xml";
+			const auto matReg = std::make_shared<MaterialsBase>(materialsPath);
+			if (verbose)
+				matReg->PrintSelf();
+
+			const auto bndCndBase = std::make_shared<BoundaryConditions>();
+
+			// Ghost slots first: FvmVector and FvmVar copy the ghost layout
+			FvmSetup::SetGhosts(*fvmMesh);
+
+			FvmVector::Init(fvmMesh);
+
+			int status;
+			{
+				auto fvmVariables = std::make_shared<FvmVar>(fvmMesh);
+
+				const FvmSetup fvmSetup(fvmMesh, bndCndBase, matReg, fvmVariables);
+				fvmSetup.SetCenters();
+
+				// Set initial conditions
+				fvmSetup.SetInitialConditions();
+
+				// Set initial flux
+				fvmSetup.SetInitialFlux();
+
+				// Set boundary velocity and pressure
+				fvmSetup.SetBoundary();
+
+				const FvmMaterial mat1 = matReg->GetMaterial("air");
+				const FvmMaterial mat2 = matReg->GetMaterial("air");
+				const FvmMaterialTable materialTable(mat1, mat2);
+				fvmSetup.SetMaterialProperties(materialTable);
+
+				status = fvmSimulation->Start(resultsDir, fvmVariables, &materialTable);
+			}
+
+			// Fields first, then the exchanges they shared
+			FvmVector::V_DestroyGhostExchanges();
+			FvmVector::Release();
+
+			if (status == LOGICAL_ERROR) {
+				PetscFinalize();
+				return EXIT_FAILURE;
+			}
+		}
 	}
 
-	fvmSimulation->ExportMeshPartitions();
-
-	// const std::string materialsPath = std::string(ASSETS_DIR) + "/materials.xml";
-	// auto matReg = std::make_shared<MaterialsBase>(materialsPath);
-	// matReg->PrintSelf();
-	//
-	// auto bndCndBase = std::make_shared<BoundaryConditions>();
-	//
-	// FvmSetup fvmSetup(fvmMesh, bndCndBase, matReg);
-	// fvmSetup.SetGhosts();
-	//
-	// FvmVector::Init(fvmMesh);
-	//
-	// auto fvmVariables = FvmVar(fvmMesh);
-	//
-	// fvmSetup.SetCenters();
-	//
-	// VecGhostGetLocalForm(FvmVar::cex, &FvmVar::cexl);
-	// VecGhostGetLocalForm(FvmVar::cey, &FvmVar::ceyl);
-	// VecGhostGetLocalForm(FvmVar::cez, &FvmVar::cezl);
-	//
-	// // Set initial conditions
-	// fvmSetup.SetInitialConditions();
-	//
-	// // Set initial flux
-	// fvmSetup.SetInitialFlux();
-	//
-	// // Set boundary velocity and pressure
-	// fvmSetup.SetBoundary();
-	//
-	// FvmMaterial mat1 = matReg->GetMaterial("air");
-	// FvmMaterial mat2 = matReg->GetMaterial("air");
-	// std::pair materials{mat1, mat2};
-	// fvmSetup.SetMaterialProperties(materials);
-	//
-	// FvmSimulation::Start("./");
-
-	// FvmVar::Deallocate();
 	PetscFinalize();
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,109 @@
+#include "Application.hpp"
+#include "FvmConvection.hpp"
+
+#include <petscsys.h>
+#include <petsctime.h>
+
+#include <array>
+#include <random>
+#include <vector>
+
+static std::string description =
+		"Convection scheme kernels - deferred-correction face loops per second\n"
+		"Options: -n <cells per edge of the box> -repeat <sweeps per scheme>\n";
+
+int main(int argc, char *argv[]) {
+	PetscInt n = 64, repeat = 20;
+
+	PetscInitialize(&argc, &argv, nullptr, description.c_str());
+	PetscOptionsGetInt(nullptr, nullptr, "-n", &n, nullptr);
+	PetscOptionsGetInt(nullptr, nullptr, "-repeat", &repeat, nullptr);
+	Application::PrintBanner("OpenFVM++ v2512");
+
+	// Hexahedral box of n^3 cells: interior faces in x, y and z order, then the boundary
+	const int elementsNb = static_cast<int>(n * n * n);
+	std::vector<int> owner, neighbour;
+	std::vector<double> dx, dy, dz;
+	const auto cell = [n](const int i, const int j, const int k) { return static_cast<int>((k * n + j) * n + i); };
+	for (int k = 0; k < n; ++k) {
+		for (int j = 0; j < n; ++j) {
+			for (int i = 0; i < n; ++i) {
+				const std::array<std::array<int, 3>, 3> steps{{{i + 1, j, k}, {i, j + 1, k}, {i, j, k + 1}}};
+				for (int d = 0; d < 3; ++d) {
+					const auto &s = steps[d];
+					if (s[0] >= n || s[1] >= n || s[2] >= n)
+						continue;
+					owner.push_back(cell(i, j, k));
+					neighbour.push_back(cell(s[0], s[1], s[2]));
+					dx.push_back(d == 0 ? 1.0 : 0.0);
+					dy.push_back(d == 1 ? 1.0 : 0.0);
+					dz.push_back(d == 2 ? 1.0 : 0.0);
+				}
+			}
+		}
+	}
+	for (int i = 0; i < 6 * n * n; ++i) {
+		owner.push_back(i % elementsNb);
+		neighbour.push_back(-1);
+		dx.push_back(0.5);
+		dy.push_back(0.0);
+		dz.push_back(0.0);
+	}
+
+	const int facesNb = static_cast<int>(owner.size());
+	const std::vector<double> weight(facesNb, 0.5);
+
+	std::mt19937 generator(2512);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+	const auto random = [&](const int size) {
+		std::vector<double> values(size);
+		for (auto &v: values)
+			v = distribution(generator);
+		return values;
+	};
+	const std::vector<double> phi = random(elementsNb);
+	const std::vector<double> gx = random(elementsNb), gy = random(elementsNb), gz = random(elementsNb);
+	const std::vector<double> massFlux = random(facesNb);
+	std::vector<double> b(elementsNb, 0.0);
+
+	const FvmConvection::Stencil stencil{
+		facesNb, elementsNb, owner.data(), neighbour.data(), weight.data(), dx.data(), dy.data(), dz.data()
+	};
+
+	PetscPrintf(PETSC_COMM_WORLD, "\n%d cells, %d faces, %d sweeps per scheme\n\n", elementsNb, facesNb,
+				static_cast<int>(repeat));
+
+	const std::array<std::pair<FvmConvection::Scheme, const char *>, 4> schemes{{
+		{FvmConvection::Scheme::CENTRAL, "central"},
+		{FvmConvection::Scheme::BLENDED, "blended"},
+		{FvmConvection::Scheme::QUICK, "QUICK"},
+		{FvmConvection::Scheme::TVD, "TVD"}
+	}};
+
+	for (const auto &[scheme, name]: schemes) {
+		// Warm-up sweep
+		FvmConvection::AddDeferredCorrection(scheme, stencil, massFlux.data(), phi.data(), gx.data(), gy.data(),
+											 gz.data(), b.data(), 0.5, 2.0);
+
+		PetscLogDouble start, end;
+		PetscTime(&start);
+		for (int r = 0; r < repeat; ++r)
+			FvmConvection::AddDeferredCorrection(scheme, stencil, massFlux.data(), phi.data(), gx.data(),
+												 gy.data(), gz.data(), b.data(), 0.5, 2.0);
+		PetscTime(&end);
+
+		const double seconds = end - start;
+		PetscPrintf(PETSC_COMM_WORLD, "%-8s %10.3e faces/s  (%.3f s)\n", name,
+					seconds > 0.0 ? static_cast<double>(facesNb) * static_cast<double>(repeat) / seconds : 0.0,
+					seconds);
+	}
+
+	// Keeps the sweeps from being optimised away
+	double checksum = 0.0;
+	for (const double v: b)
+		checksum += v;
+	PetscPrintf(PETSC_COMM_WORLD, "\nchecksum %.6e\n", checksum);
+
+	PetscFinalize();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+#include "Application.hpp"
+#include "FvmFaceMap.hpp"
+
+#include <petscsys.h>
+#include <petsctime.h>
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <vector>
+
+static std::string description =
+		"FVM face matching - std::map<std::set<int>, int> against FaceHashMap\n"
+		"Options: -n <cubes per edge of the box, 6 tetrahedra each> -repeat <builds per method>\n";
+
+using FvmMesh::FaceVertices;
+
+//! Faces of a tetrahedron in the order of GetFaceVertices (FvmMesh.cpp)
+static FaceVertices TetFace(const std::array<int, 4> &v, const int f) {
+	static constexpr int faces[4][3] = {{0, 1, 2}, {0, 1, 3}, {1, 2, 3}, {2, 0, 3}};
+	FaceVertices face;
+	for (const int k: faces[f])
+		face.v[face.n++] = v[k];
+	return face;
+}
+
+//! Owner, pair (-1 on boundaries) and surface element (-1 inside) per face, numbered in order of first visit
+struct FaceTable {
+	std::vector<int> owner, pair, surface;
+
+	bool operator==(const FaceTable &other) const = default;
+};
+
+int main(int argc, char *argv[]) {
+	PetscInt n = 40, repeat = 3;
+
+	PetscInitialize(&argc, &argv, nullptr, description.c_str());
+	PetscOptionsGetInt(nullptr, nullptr, "-n", &n, nullptr);
+	PetscOptionsGetInt(nullptr, nullptr, "-repeat", &repeat, nullptr);
+	Application::PrintBanner("OpenFVM++ v2512");
+
+	// Structured box of n^3 cubes, each split into the 6 tetrahedra around its main diagonal
+	const auto node = [n](const int i, const int j, const int k) {
+		return static_cast<int>((k * (n + 1) + j) * (n + 1) + i);
+	};
+	std::vector<std::array<int, 4> > tets;
+	for (int k = 0; k < n; ++k) {
+		for (int j = 0; j < n; ++j) {
+			for (int i = 0; i < n; ++i) {
+				const std::array<std::array<int, 3>, 6> orders{{
+					{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}
+				}};
+				for (const auto &order: orders) {
+					std::array<int, 3> p{i, j, k};
+					std::array<int, 4> tet{};
+					tet[0] = node(p[0], p[1], p[2]);
+					for (int s = 0; s < 3; ++s) {
+						++p[order[s]];
+						tet[s + 1] = node(p[0], p[1], p[2]);
+					}
+					tets.push_back(tet);
+				}
+			}
+		}
+	}
+
+	const int elementsNb = static_cast<int>(tets.size());
+	const int nodesNb = node(n, n, n) + 1;
+
+	// Surface triangles: tetrahedron faces with all three nodes on one side of the box
+	std::vector<FaceVertices> surface;
+	const auto onSide = [n](const int v, const int axis, const int value) {
+		const std::array<int, 3> p{v % (n + 1), v / (n + 1) % (n + 1), v / ((n + 1) * (n + 1))};
+		return p[axis] == value;
+	};
+	for (const auto &tet: tets) {
+		for (int f = 0; f < 4; ++f) {
+			const FaceVertices face = TetFace(tet, f);
+			for (int axis = 0; axis < 3; ++axis) {
+				for (const int value: {0, static_cast<int>(n)}) {
+					if (onSide(face.v[0], axis, value) && onSide(face.v[1], axis, value) &&
+						onSide(face.v[2], axis, value))
+						surface.push_back(face);
+				}
+			}
+		}
+	}
+	const int surfaceNb = static_cast<int>(surface.size());
+	const std::size_t expectedFaces = (4 * static_cast<std::size_t>(elementsNb) + surfaceNb) / 2;
+
+	// Node numberings: as generated, randomly shuffled, and surface nodes first (as Netgen numbers them)
+	std::vector<int> lexicographic(nodesNb);
+	std::iota(lexicographic.begin(), lexicographic.end(), 0);
+
+	std::vector<int> shuffled = lexicographic;
+	std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(2512));
+
+	std::vector<int> surfaceFirst(nodesNb, -1);
+	int next = 0;
+	for (const auto &face: surface) {
+		for (int k = 0; k < face.n; ++k) {
+			if (surfaceFirst[face.v[k]] == -1)
+				surfaceFirst[face.v[k]] = next++;
+		}
+	}
+	for (auto &id: surfaceFirst) {
+		if (id == -1)
+			id = next++;
+	}
+
+	PetscPrintf(PETSC_COMM_WORLD, "\n%d tetrahedra, %d surface triangles, %d nodes, %d builds per method\n",
+				elementsNb, surfaceNb, nodesNb, static_cast<int>(repeat));
+
+	const std::array<std::pair<const std::vector<int> *, const char *>, 3> numberings{{
+		{&lexicographic, "lexicographic"},
+		{&shuffled, "shuffled"},
+		{&surfaceFirst, "surface-first"}
+	}};
+
+	bool identical = true;
+	for (const auto &[numbering, name]: numberings) {
+		const auto renumber = [numbering](FaceVertices face) {
+			for (int k = 0; k < face.n; ++k)
+				face.v[k] = (*numbering)[face.v[k]];
+			return face;
+		};
+
+		std::vector<std::array<int, 4> > elements(tets);
+		for (auto &tet: elements) {
+			for (auto &v: tet)
+				v = (*numbering)[v];
+		}
+		std::vector<FaceVertices> surfaceFaces;
+		surfaceFaces.reserve(surfaceNb);
+		for (const auto &face: surface)
+			surfaceFaces.push_back(renumber(face));
+
+		// Before: ordered maps of vertex sets, one node allocation per face and per lookup key
+		const auto mapMatch = [&] {
+			FaceTable table;
+			std::map<std::set<int>, int> boundaryFaceMap, faceMap;
+			for (int i = 0; i < surfaceNb; ++i) {
+				const FaceVertices &verts = surfaceFaces[i];
+				boundaryFaceMap[std::set<int>(verts.v.begin(), verts.v.begin() + verts.n)] = i;
+			}
+
+			for (int e = 0; e < elementsNb; ++e) {
+				for (int f = 0; f < 4; ++f) {
+					const FaceVertices verts = TetFace(elements[e], f);
+					std::set<int> key(verts.v.begin(), verts.v.begin() + verts.n);
+
+					auto it = faceMap.find(key);
+					if (it == faceMap.end()) {
+						faceMap[key] = static_cast<int>(table.owner.size());
+						const auto se = boundaryFaceMap.find(key);
+						table.owner.push_back(e);
+						table.pair.push_back(-1);
+						table.surface.push_back(se != boundaryFaceMap.end() ? se->second : -1);
+					} else {
+						table.pair[it->second] = e;
+					}
+				}
+			}
+			return table;
+		};
+
+		// After: open-addressing tables of fixed-width sorted keys, as in FvmMeshContainer::BuildFvmMesh
+		const auto hashMatch = [&] {
+			FaceTable table;
+			table.owner.reserve(expectedFaces);
+			table.pair.reserve(expectedFaces);
+			table.surface.reserve(expectedFaces);
+
+			FaceHashMap boundaryFaceMap(surfaceNb);
+			for (int i = 0; i < surfaceNb; ++i)
+				boundaryFaceMap.InsertOrAssign(FvmMesh::MakeFaceKey(surfaceFaces[i]), i);
+
+			FaceHashMap faceMap(expectedFaces);
+			for (int e = 0; e < elementsNb; ++e) {
+				for (int f = 0; f < 4; ++f) {
+					const FvmMesh::FaceKey key = FvmMesh::MakeFaceKey(TetFace(elements[e], f));
+
+					auto [index, inserted] = faceMap.TryEmplace(key, static_cast<int>(table.owner.size()));
+					if (inserted) {
+						table.owner.push_back(e);
+						table.pair.push_back(-1);
+						table.surface.push_back(boundaryFaceMap.Find(key));
+					} else {
+						table.pair[index] = e;
+					}
+				}
+			}
+			return table;
+		};
+
+		const auto time = [&](const auto &match, FaceTable &table) {
+			PetscLogDouble start, end;
+			PetscTime(&start);
+			for (int r = 0; r < repeat; ++r)
+				table = match();
+			PetscTime(&end);
+
+			return (end - start) / static_cast<double>(repeat > 0 ? repeat : 1);
+		};
+
+		FaceTable before, after;
+		const double mapSeconds = time(mapMatch, before);
+		const double hashSeconds = time(hashMatch, after);
+
+		const bool same = before == after;
+		identical = identical && same;
+		PetscPrintf(PETSC_COMM_WORLD, "\n%-14s std::map %8.3f s   hash %8.3f s   speed-up %6.1fx   %zu faces, %s\n",
+					name, mapSeconds, hashSeconds, hashSeconds > 0.0 ? mapSeconds / hashSeconds : 0.0,
+					after.owner.size(), same ? "identical" : "DIFFERENT");
+	}
+
+	PetscFinalize();
+	return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
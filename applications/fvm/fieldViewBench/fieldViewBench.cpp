@@ -0,0 +1,95 @@
+#include "Application.hpp"
+#include "FvmFieldView.hpp"
+
+#include <petscsys.h>
+#include <petsctime.h>
+#include <petscvec.h>
+
+#include <array>
+
+static std::string description =
+		"Field access - per-entry VecGetValues/VecSetValue against RAII field views\n"
+		"Options: -n <cells per rank> -repeat <sweeps per access mode>\n";
+
+// The per-entry access FvmVector::V_GetCmp / V_SetCmp provided before the field views
+static double GetCmp(const Vec v, const PetscInt index) {
+	double value;
+	VecGetValues(v, 1, &index, &value);
+	return value;
+}
+
+static void SetCmp(const Vec v, const PetscInt index, const double value) {
+	VecSetValue(v, index, value, INSERT_VALUES);
+}
+
+int main(int argc, char *argv[]) {
+	PetscInt n = 1000000, repeat = 20;
+
+	PetscInitialize(&argc, &argv, nullptr, description.c_str());
+	PetscOptionsGetInt(nullptr, nullptr, "-n", &n, nullptr);
+	PetscOptionsGetInt(nullptr, nullptr, "-repeat", &repeat, nullptr);
+	Application::PrintBanner("OpenFVM++ v2512");
+
+	// Three inputs and one output per cell, like a cell loop of the setup routines
+	std::array<Vec, 4> fields{};
+	VecCreateMPI(PETSC_COMM_WORLD, n, PETSC_DECIDE, &fields[0]);
+	for (int f = 1; f < 4; ++f)
+		VecDuplicate(fields[0], &fields[f]);
+	VecSet(fields[0], 1.0);
+	VecSet(fields[1], 2.0);
+	VecSet(fields[2], 0.5);
+
+	PetscInt start;
+	VecGetOwnershipRange(fields[0], &start, nullptr);
+
+	PetscPrintf(PETSC_COMM_WORLD, "\n%d cells per rank, 3 reads and 1 write per cell, %d sweeps\n\n",
+				static_cast<int>(n), static_cast<int>(repeat));
+
+	const auto perEntry = [&] {
+		for (PetscInt i = 0; i < n; ++i) {
+			const PetscInt row = start + i;
+			SetCmp(fields[3], row, GetCmp(fields[0], row) + GetCmp(fields[1], row) * GetCmp(fields[2], row));
+		}
+		VecAssemblyBegin(fields[3]);
+		VecAssemblyEnd(fields[3]);
+	};
+
+	const auto views = [&] {
+		const FieldRead a(fields[0]), b(fields[1]), c(fields[2]);
+		const FieldWrite result(fields[3]);
+		for (PetscInt i = 0; i < n; ++i)
+			result[i] = a[i] + b[i] * c[i];
+	};
+
+	const auto time = [&](const char *name, const auto &sweep) {
+		// Warm-up sweep
+		sweep();
+
+		PetscLogDouble begin, end;
+		PetscTime(&begin);
+		for (int r = 0; r < repeat; ++r)
+			sweep();
+		PetscTime(&end);
+
+		PetscReal sum;
+		VecSum(fields[3], &sum);
+
+		const double seconds = end - begin;
+		PetscPrintf(PETSC_COMM_WORLD, "%-10s %10.3e cells/s  (%.3f s, checksum %.6e)\n", name,
+					seconds > 0.0 ? static_cast<double>(n) * static_cast<double>(repeat) / seconds : 0.0,
+					seconds, static_cast<double>(sum));
+		return seconds;
+	};
+
+	const double before = time("per-entry", perEntry);
+	VecZeroEntries(fields[3]);
+	const double after = time("views", views);
+
+	PetscPrintf(PETSC_COMM_WORLD, "\nspeed-up %.1fx\n", after > 0.0 ? before / after : 0.0);
+
+	for (auto &field: fields)
+		VecDestroy(&field);
+
+	PetscFinalize();
+	return EXIT_SUCCESS;
+}
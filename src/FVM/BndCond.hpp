@@ -1,10 +1,12 @@
 #ifndef BOUNDARYCONDITIONS_HPP
 #define BOUNDARYCONDITIONS_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
-enum class BndCondType {
+//! One byte per code, so per-face arrays stay compact
+enum class BndCondType : std::uint8_t {
     NONE = 0,
     EMPTY,
     CYCLIC,
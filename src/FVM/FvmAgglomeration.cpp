@@ -0,0 +1,198 @@
+#include "FvmAgglomeration.hpp"
+#include "FvmMesh.hpp"
+#include "FvmLog.hpp"
+#include "Globals.hpp"
+
+#include <algorithm>
+
+namespace {
+    //! Start of the rank's rows in a distributed numbering of n local rows
+    int RowOffset(const int n) {
+        int rank, offset = 0;
+        MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+        MPI_Exscan(&n, &offset, 1, MPI_INT, MPI_SUM, PETSC_COMM_WORLD);
+        return rank == 0 ? 0 : offset;
+    }
+
+    int GlobalSum(const int n) {
+        int sum;
+        MPI_Allreduce(&n, &sum, 1, MPI_INT, MPI_SUM, PETSC_COMM_WORLD);
+        return sum;
+    }
+}
+
+FvmAgglomeration::FvmAgglomeration(const FvmMeshContainer &mesh) {
+    PetscLogEventBegin(FvmLog::Event("FvmAgglomeration"), 0, 0, 0, 0);
+
+    const auto faces = mesh.storage.Faces();
+    const auto coefficients = mesh.faceCoefficients.View();
+
+    // Processor faces are left out: aggregates stay on their rank
+    std::vector<Edge> edges;
+    edges.reserve(faces.size);
+    for (int i = 0; i < faces.size; ++i) {
+        if (faces.pair[i] != -1)
+            edges.push_back({faces.owner[i], faces.pair[i], coefficients.diffusion[i]});
+    }
+
+    int cellsNb = mesh.elementsNb;
+    int globalCellsNb = GlobalSum(cellsNb);
+    std::vector<int> globalCells{globalCellsNb};
+    _cellsNb.push_back(cellsNb);
+
+    while (globalCellsNb > coarsestCells && LevelsNumber() < maxLevels) {
+        std::vector<int> first, second;
+        const int pairsNb = Match(cellsNb, edges, first);
+        const std::vector<Edge> pairEdges = CoarsenEdges(edges, first);
+        const int aggregatesNb = Match(pairsNb, pairEdges, second);
+
+        // Isolated cells and ranks without faces stop shrinking
+        const int globalAggregatesNb = GlobalSum(aggregatesNb);
+        if (5 * static_cast<long long>(globalAggregatesNb) > 4 * static_cast<long long>(globalCellsNb))
+            break;
+
+        for (int &aggregate: first)
+            aggregate = second[aggregate];
+
+        edges = CoarsenEdges(pairEdges, second);
+        _aggregates.push_back(std::move(first));
+        _cellsNb.push_back(aggregatesNb);
+        globalCells.push_back(globalAggregatesNb);
+
+        cellsNb = aggregatesNb;
+        globalCellsNb = globalAggregatesNb;
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmAgglomeration"), 0, 0, 0, 0);
+
+    PetscPrintf(PETSC_COMM_WORLD, "Agglomeration multigrid: %d levels, cells:", LevelsNumber());
+    for (const int cells: globalCells)
+        PetscPrintf(PETSC_COMM_WORLD, " %d", cells);
+    PetscPrintf(PETSC_COMM_WORLD, "\n");
+}
+
+int FvmAgglomeration::Match(const int cellsNb, const std::vector<Edge> &edges, std::vector<int> &aggregates) {
+    // Compressed adjacency of the local graph
+    std::vector<int> offsets(cellsNb + 1, 0);
+    for (const auto &edge: edges) {
+        ++offsets[edge.first + 1];
+        ++offsets[edge.second + 1];
+    }
+    for (int i = 0; i < cellsNb; ++i)
+        offsets[i + 1] += offsets[i];
+
+    std::vector<int> neighbours(offsets.back());
+    std::vector<double> weights(offsets.back());
+    std::vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (const auto &edge: edges) {
+        neighbours[next[edge.first]] = edge.second;
+        weights[next[edge.first]++] = edge.weight;
+        neighbours[next[edge.second]] = edge.first;
+        weights[next[edge.second]++] = edge.weight;
+    }
+
+    aggregates.assign(cellsNb, -1);
+    int aggregatesNb = 0;
+
+    for (int i = 0; i < cellsNb; ++i) {
+        if (aggregates[i] != -1)
+            continue;
+
+        int freeNeighbour = -1, takenNeighbour = -1;
+        double freeWeight = -1.0, takenWeight = -1.0;
+        for (int k = offsets[i]; k < offsets[i + 1]; ++k) {
+            const int j = neighbours[k];
+            if (aggregates[j] == -1 && weights[k] > freeWeight) {
+                freeNeighbour = j;
+                freeWeight = weights[k];
+            } else if (aggregates[j] != -1 && weights[k] > takenWeight) {
+                takenNeighbour = j;
+                takenWeight = weights[k];
+            }
+        }
+
+        if (freeNeighbour != -1) {
+            aggregates[i] = aggregates[freeNeighbour] = aggregatesNb++;
+        } else if (takenNeighbour != -1) {
+            // Every neighbour is paired: join the strongest one
+            aggregates[i] = aggregates[takenNeighbour];
+        } else {
+            aggregates[i] = aggregatesNb++;
+        }
+    }
+
+    return aggregatesNb;
+}
+
+std::vector<FvmAgglomeration::Edge> FvmAgglomeration::CoarsenEdges(const std::vector<Edge> &edges,
+                                                                   const std::vector<int> &aggregates) {
+    std::vector<Edge> coarse;
+    coarse.reserve(edges.size());
+    for (const auto &edge: edges) {
+        const int first = aggregates[edge.first];
+        const int second = aggregates[edge.second];
+        if (first != second)
+            coarse.push_back({LMIN(first, second), LMAX(first, second), edge.weight});
+    }
+
+    std::sort(coarse.begin(), coarse.end(), [](const Edge &a, const Edge &b) {
+        return a.first != b.first ? a.first < b.first : a.second < b.second;
+    });
+
+    // Sum the fine faces between the same two aggregates
+    std::size_t last = 0;
+    for (std::size_t i = 1; i < coarse.size(); ++i) {
+        if (coarse[i].first == coarse[last].first && coarse[i].second == coarse[last].second)
+            coarse[last].weight += coarse[i].weight;
+        else
+            coarse[++last] = coarse[i];
+    }
+    if (!coarse.empty())
+        coarse.resize(last + 1);
+
+    return coarse;
+}
+
+void FvmAgglomeration::SetupPreconditioner(const PC pc) const {
+    const int levels = LevelsNumber();
+
+    PCSetType(pc, PCMG);
+    PCMGSetLevels(pc, levels, nullptr);
+    PCMGSetType(pc, PC_MG_MULTIPLICATIVE);
+    PCMGSetCycleType(pc, PC_MG_CYCLE_V);
+    PCMGSetGalerkin(pc, PC_MG_GALERKIN_BOTH);
+
+    // A floating operator (constant null space, closed domains) has singular Galerkin
+    // coarse operators, which the default coarse LU cannot factor; SVD drops the null mode
+    Mat matrix = nullptr;
+    MatNullSpace nullSpace = nullptr;
+    PCGetOperators(pc, &matrix, nullptr);
+    if (matrix)
+        MatGetNullSpace(matrix, &nullSpace);
+
+    if (nullSpace) {
+        KSP coarse;
+        PC coarsePc;
+        PCMGGetCoarseSolve(pc, &coarse);
+        KSPSetType(coarse, KSPPREONLY);
+        KSPGetPC(coarse, &coarsePc);
+        PCSetType(coarsePc, PCSVD);
+    }
+
+    // PCMG numbers its levels from the coarsest one
+    for (int k = 0; k + 1 < levels; ++k) {
+        const int fineNb = _cellsNb[k], coarseNb = _cellsNb[k + 1];
+        const int fineOffset = RowOffset(fineNb), coarseOffset = RowOffset(coarseNb);
+
+        Mat prolongation;
+        MatCreateAIJ(PETSC_COMM_WORLD, fineNb, coarseNb, PETSC_DETERMINE, PETSC_DETERMINE,
+                     1, nullptr, 0, nullptr, &prolongation);
+        for (int i = 0; i < fineNb; ++i)
+            MatSetValue(prolongation, fineOffset + i, coarseOffset + _aggregates[k][i], 1.0, INSERT_VALUES);
+        MatAssemblyBegin(prolongation, MAT_FINAL_ASSEMBLY);
+        MatAssemblyEnd(prolongation, MAT_FINAL_ASSEMBLY);
+
+        PCMGSetInterpolation(pc, levels - 1 - k, prolongation);
+        MatDestroy(&prolongation);
+    }
+}
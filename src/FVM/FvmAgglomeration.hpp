@@ -0,0 +1,54 @@
+#ifndef FVMAGGLOMERATION_HPP
+#define FVMAGGLOMERATION_HPP
+
+#include <vector>
+
+#include "petscksp.h"
+
+class FvmMeshContainer;
+
+/**
+ * Agglomeration multigrid hierarchy built from the face graph of the mesh.
+ * Every interior face couples its two cells with its cached diffusion
+ * coefficient (FvmMeshStorage::Coefficients), the geometric part of the
+ * Laplacian coefficient the pressure matrix is assembled with. A level merges each cell with
+ * its most strongly coupled free neighbour, twice (pairwise matching), so
+ * coarse cells hold about four fine cells; coarse faces sum the weights of
+ * the fine faces they replace.
+ *
+ * Aggregates never cross processor patches, so every rank coarsens its own
+ * cells and the prolongations are plain piecewise-constant AIJ matrices.
+ * With those, the Galerkin coarse operator P^T A P is just the sum of the
+ * fine coefficients between two aggregates, which PCMG forms on setup.
+ */
+class FvmAgglomeration {
+public:
+    explicit FvmAgglomeration(const FvmMeshContainer &mesh);
+
+    //! Turns pc into a PCMG on this hierarchy (Galerkin coarse operators). Set the operators
+    //! of pc first: with a null space attached to them the coarse level is solved by SVD
+    void SetupPreconditioner(PC pc) const;
+
+    [[nodiscard]] int LevelsNumber() const { return static_cast<int>(_cellsNb.size()); }
+
+private:
+    struct Edge {
+        int first, second;
+        double weight;
+    };
+
+    //! Cell -> aggregate map of one pairwise matching; returns the aggregates number
+    static int Match(int cellsNb, const std::vector<Edge> &edges, std::vector<int> &aggregates);
+
+    //! Coarse edges with the weights summed over the fine edges
+    static std::vector<Edge> CoarsenEdges(const std::vector<Edge> &edges, const std::vector<int> &aggregates);
+
+private:
+    static constexpr int coarsestCells = 500; //! Stop coarsening below this global size
+    static constexpr int maxLevels = 16;
+
+    std::vector<int> _cellsNb; //! Local cells per level, finest first
+    std::vector<std::vector<int> > _aggregates; //! Level l cell -> level l + 1 cell
+};
+
+#endif
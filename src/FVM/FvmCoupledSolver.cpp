@@ -0,0 +1,412 @@
+#include "FvmCoupledSolver.hpp"
+#include "FvmMesh.hpp"
+#include "FvmVar.hpp"
+#include "FvmVector.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmLog.hpp"
+#include "FvmParam.hpp"
+#include "FvmFlowFaces.hpp"
+#include "FvmFaceLoop.hpp"
+
+#include <algorithm>
+
+using namespace FvmMesh;
+using namespace FvmFlow;
+
+namespace {
+    constexpr int U = ToInt(FieldIndex::U);
+    constexpr int V = ToInt(FieldIndex::V);
+    constexpr int W = ToInt(FieldIndex::W);
+    constexpr int P = ToInt(FieldIndex::P);
+
+    //! Entry (row, column) of a row-major 4x4 block
+    constexpr int At(const int row, const int column) { return 4 * row + column; }
+}
+
+FvmCoupledSolver::FvmCoupledSolver(const std::shared_ptr<FvmMeshContainer> &fvmMesh,
+                                   const std::shared_ptr<FvmVar> &fvmVar)
+    : _fvmMesh(fvmMesh),
+      _fvmVar(fvmVar),
+      _sparsity(*fvmMesh),
+      _gradient(fvmMesh, fvmVar),
+      _momentum(fvmMesh, fvmVar, _gradient) {
+    if (!_fvmVar->IsActive(FvmVar::FieldSet::FLOW))
+        throw FvmException("Coupled solver needs the flow fields (fvmParameter.calc)", LOGICAL_ERROR);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    _diagonalBlocks.resize(blockSize * blockSize * elementsNb);
+
+    VecDuplicate(_fvmVar->xu, &_fvmVar->bu);
+    VecDuplicate(_fvmVar->xv, &_fvmVar->bv);
+    VecDuplicate(_fvmVar->xw, &_fvmVar->bw);
+    for (auto &gradient: _gradP)
+        VecDuplicate(_fvmVar->xp, &gradient);
+
+    // Block vectors share the cell ghosts of the scalar fields
+    VecCreateGhostBlock(PETSC_COMM_WORLD, blockSize, blockSize * elementsNb, PETSC_DECIDE,
+                        _fvmMesh->ghostsNb, _fvmMesh->ghosts.data(), &_x);
+    VecDuplicate(_x, &_b);
+    VecDuplicate(_x, &_residual);
+
+    _sparsity.CreateMatrix(&_matrix, blockSize);
+
+    int fixed = 0;
+    const auto faces = _fvmMesh->storage.Faces();
+    for (int i = 0; i < faces.size; ++i) {
+        if (Neighbour(faces, i) == -1 && GetBoundaryKind(faces.bc[i]) == BoundaryKind::PRESSURE)
+            fixed = 1;
+    }
+
+    int globalFixed;
+    MPI_Allreduce(&fixed, &globalFixed, 1, MPI_INT, MPI_MAX, PETSC_COMM_WORLD);
+    _pressureFixed = globalFixed == 1;
+
+    if (!_pressureFixed) {
+        // Closed domain: constant pressure, zero velocity
+        Vec mode;
+        VecDuplicate(_x, &mode);
+        {
+            const FieldWrite m(mode);
+            for (int i = 0; i < elementsNb; ++i) {
+                m[blockSize * i + U] = 0.0;
+                m[blockSize * i + V] = 0.0;
+                m[blockSize * i + W] = 0.0;
+                m[blockSize * i + P] = 1.0;
+            }
+        }
+        VecNormalize(mode, nullptr);
+
+        MatNullSpace nullSpace;
+        MatNullSpaceCreate(PETSC_COMM_WORLD, PETSC_FALSE, 1, &mode, &nullSpace);
+        MatSetNullSpace(_matrix, nullSpace);
+        MatNullSpaceDestroy(&nullSpace);
+        VecDestroy(&mode);
+    }
+
+    KSPCreate(PETSC_COMM_WORLD, &_ksp);
+    KSPSetOptionsPrefix(_ksp, "coupled_");
+    KSPSetOperators(_ksp, _matrix, _matrix);
+    KSPSetType(_ksp, KSPFGMRES);
+    KSPSetTolerances(_ksp, fvmParameter.mtol[P], PETSC_DEFAULT, PETSC_DEFAULT, fvmParameter.miter[P]);
+    KSPSetInitialGuessNonzero(_ksp, PETSC_TRUE);
+
+    PC pc;
+    KSPGetPC(_ksp, &pc);
+    PCSetType(pc, PCFIELDSPLIT);
+    PCFieldSplitSetBlockSize(pc, blockSize);
+
+    const PetscInt velocityFields[] = {U, V, W};
+    const PetscInt pressureFields[] = {P};
+    PCFieldSplitSetFields(pc, "u", 3, velocityFields, velocityFields);
+    PCFieldSplitSetFields(pc, "p", 1, pressureFields, pressureFields);
+    PCFieldSplitSetType(pc, PC_COMPOSITE_SCHUR);
+    PCFieldSplitSetSchurFactType(pc, PC_FIELDSPLIT_SCHUR_FACT_FULL);
+    PCFieldSplitSetSchurPre(pc, PC_FIELDSPLIT_SCHUR_PRE_SELFP, nullptr);
+
+    KSPSetFromOptions(_ksp);
+
+    PetscPrintf(PETSC_COMM_WORLD, "\nFlow solver: coupled (u, v, w, p) blocks, pressure level %s\n",
+                _pressureFixed ? "fixed by boundaries" : "floating");
+}
+
+FvmCoupledSolver::~FvmCoupledSolver() {
+    if (_ksp)
+        KSPDestroy(&_ksp);
+    if (_matrix)
+        MatDestroy(&_matrix);
+    for (Vec *vec: {&_x, &_b, &_residual, &_gradP[0], &_gradP[1], &_gradP[2]}) {
+        if (*vec)
+            VecDestroy(vec);
+    }
+}
+
+PetscInt FvmCoupledSolver::GlobalBlock(const int cell) const {
+    const int elementsNb = _fvmMesh->elementsNb;
+    return cell < elementsNb ? _fvmMesh->cellOffset + cell : _fvmMesh->ghosts[cell - elementsNb];
+}
+
+void FvmCoupledSolver::Iterate(const double dt, std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter) {
+    PetscLogEventBegin(FvmLog::Event("FvmCoupledIterate"), 0, 0, 0, 0);
+
+    FvmVector::V_GhostUpdate({_fvmVar->xu, _fvmVar->xv, _fvmVar->xw, _fvmVar->xp});
+
+    // The pressure is implicit in momentum, so only ef[U] relaxes the system
+    ComputePressureGradient();
+    BuildMomentumCoefficients(dt);
+    BuildSystem();
+    SolveSystem(fres, fiter);
+    CorrectFlux();
+
+    PetscLogEventEnd(FvmLog::Event("FvmCoupledIterate"), 0, 0, 0, 0);
+}
+
+void FvmCoupledSolver::ComputePressureGradient() {
+    _gradient.Compute({{_fvmVar->xp, _fvmVar->xpf, FixesPressure, _gradP}},
+                      static_cast<FvmGradientMethod>(fvmParameter.gradient), FvmGradientLimiter::NONE);
+}
+
+void FvmCoupledSolver::BuildMomentumCoefficients(const double dt) {
+    // Same discretisation as FvmFlowSolver, convection scheme included
+    _momentum.Assemble(dt);
+
+    {
+        const auto elements = _fvmMesh->storage.Elements();
+        const FieldRead ap(_fvmVar->ap);
+        const FieldWrite rAU(_fvmVar->temp1);
+        for (int i = 0; i < elements.size; ++i)
+            rAU[i] = elements.Vp[i] / ap[i];
+    }
+}
+
+void FvmCoupledSolver::BuildSystem() {
+    PetscLogEventBegin(FvmLog::Event("FvmCoupledMatrix"), 0, 0, 0, 0);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+    constexpr int blockEntries = blockSize * blockSize;
+
+    std::fill(_diagonalBlocks.begin(), _diagonalBlocks.end(), 0.0);
+
+    // Inactive velocity components keep their value: identity rows
+    std::array<bool, 3> active{};
+    for (const int c: {U, V, W})
+        active[c] = fvmParameter.calc[c] != 0;
+
+    const auto maskRows = [&active](PetscScalar *block) {
+        for (const int c: {U, V, W}) {
+            if (!active[c])
+                std::fill_n(block + At(c, 0), blockSize, 0.0);
+        }
+    };
+
+    {
+        const FieldRead bu(_fvmVar->bu), bv(_fvmVar->bv), bw(_fvmVar->bw), ap(_fvmVar->ap);
+        const FieldWrite b(_b);
+
+        for (int i = 0; i < elementsNb; ++i) {
+            PetscScalar *block = &_diagonalBlocks[blockEntries * i];
+            for (const int c: {U, V, W})
+                block[At(c, c)] = ap[i];
+
+            b[blockSize * i + U] = bu[i];
+            b[blockSize * i + V] = bv[i];
+            b[blockSize * i + W] = bw[i];
+            b[blockSize * i + P] = 0.0;
+        }
+    }
+
+    // The ghosts of temp1 arrive while the interior faces are assembled
+    OverlappedFaceLoop(_fvmMesh->faceSplit, {_fvmVar->temp1}, [&](const std::span<const int> faceList) {
+        const GhostedFieldRead dens(_fvmVar->dens), rAU(_fvmVar->temp1);
+        const GhostedFieldRead gx(_gradP[0]), gy(_gradP[1]), gz(_gradP[2]);
+        const GhostedFieldRead xuf(_fvmVar->xuf), xvf(_fvmVar->xvf), xwf(_fvmVar->xwf), xpf(_fvmVar->xpf);
+        const FieldWrite b(_b);
+
+        for (const int i: faceList) {
+            const int owner = faces.owner[i];
+            const int neighbour = Neighbour(faces, i);
+            const double s = coefficients.orientation[i];
+            const std::array<double, 3> n{s * faces.nx[i], s * faces.ny[i], s * faces.nz[i]};
+            const double Aj = faces.Aj[i];
+
+            PetscScalar *diagonal = &_diagonalBlocks[blockEntries * owner];
+
+            if (neighbour != -1) {
+                const double lambda = coefficients.lambda[i];
+                const double densf = Interpolate(dens, owner, neighbour, lambda);
+                const double rAUf = Interpolate(rAU, owner, neighbour, lambda);
+                const double a = densf * rAUf * Aj * coefficients.inverseDistance[i];
+
+                // Lagged part of the Rhie-Chow flux
+                const double gradient = Interpolate(gx, owner, neighbour, lambda) * n[0] +
+                                        Interpolate(gy, owner, neighbour, lambda) * n[1] +
+                                        Interpolate(gz, owner, neighbour, lambda) * n[2];
+                const double explicitFlux = densf * rAUf * gradient * Aj;
+
+                // Owner row: neighbour coefficient, p_f S_f and the continuity flux
+                std::array<PetscScalar, blockEntries> offDiagonal{};
+                for (const int c: {U, V, W}) {
+                    offDiagonal[At(c, c)] = _momentum.OwnerCoefficient(i);
+                    diagonal[At(c, P)] += (1.0 - lambda) * n[c] * Aj;
+                    offDiagonal[At(c, P)] = lambda * n[c] * Aj;
+                    diagonal[At(P, c)] += densf * (1.0 - lambda) * n[c] * Aj;
+                    offDiagonal[At(P, c)] = densf * lambda * n[c] * Aj;
+                }
+                diagonal[At(P, P)] += a;
+                offDiagonal[At(P, P)] = -a;
+                b[blockSize * owner + P] -= explicitFlux;
+
+                maskRows(offDiagonal.data());
+                const PetscInt row = GlobalBlock(owner), column = GlobalBlock(neighbour);
+                MatSetValuesBlocked(_matrix, 1, &row, 1, &column, offDiagonal.data(), INSERT_VALUES);
+
+                if (neighbour < elementsNb) {
+                    // Neighbour row: the outward normal is -n
+                    PetscScalar *neighbourDiagonal = &_diagonalBlocks[blockEntries * neighbour];
+                    offDiagonal.fill(0.0);
+                    for (const int c: {U, V, W}) {
+                        offDiagonal[At(c, c)] = _momentum.NeighbourCoefficient(i);
+                        neighbourDiagonal[At(c, P)] -= lambda * n[c] * Aj;
+                        offDiagonal[At(c, P)] = -(1.0 - lambda) * n[c] * Aj;
+                        neighbourDiagonal[At(P, c)] -= densf * lambda * n[c] * Aj;
+                        offDiagonal[At(P, c)] = -densf * (1.0 - lambda) * n[c] * Aj;
+                    }
+                    neighbourDiagonal[At(P, P)] += a;
+                    offDiagonal[At(P, P)] = -a;
+                    b[blockSize * neighbour + P] += explicitFlux;
+
+                    maskRows(offDiagonal.data());
+                    MatSetValuesBlocked(_matrix, 1, &column, 1, &row, offDiagonal.data(), INSERT_VALUES);
+                }
+                continue;
+            }
+
+            switch (GetBoundaryKind(faces.bc[i])) {
+                case BoundaryKind::VELOCITY:
+                    for (const int c: {U, V, W})
+                        diagonal[At(c, P)] += n[c] * Aj;
+                    b[blockSize * owner + P] -= dens[owner] * (xuf[i] * n[0] + xvf[i] * n[1] + xwf[i] * n[2]) * Aj;
+                    break;
+                case BoundaryKind::PRESSURE: {
+                    const double a = dens[owner] * rAU[owner] * Aj * coefficients.inverseDistance[i];
+                    const double gradient = gx[owner] * n[0] + gy[owner] * n[1] + gz[owner] * n[2];
+
+                    for (const int c: {U, V, W}) {
+                        b[blockSize * owner + c] -= xpf[i] * n[c] * Aj;
+                        diagonal[At(P, c)] += dens[owner] * n[c] * Aj;
+                    }
+                    diagonal[At(P, P)] += a;
+                    b[blockSize * owner + P] += a * xpf[i] - dens[owner] * rAU[owner] * gradient * Aj;
+                    break;
+                }
+                case BoundaryKind::NO_FLUX:
+                    for (const int c: {U, V, W})
+                        diagonal[At(c, P)] += n[c] * Aj;
+                    break;
+            }
+        }
+    });
+
+    {
+        const FieldRead xu(_fvmVar->xu), xv(_fvmVar->xv), xw(_fvmVar->xw);
+        const FieldWrite b(_b);
+
+        const std::array<const FieldRead *, 3> x{&xu, &xv, &xw};
+        for (int i = 0; i < elementsNb; ++i) {
+            PetscScalar *block = &_diagonalBlocks[blockEntries * i];
+            maskRows(block);
+            for (const int c: {U, V, W}) {
+                if (active[c])
+                    continue;
+                block[At(c, c)] = 1.0;
+                b[blockSize * i + c] = (*x[c])[i];
+            }
+
+            const PetscInt row = GlobalBlock(i);
+            MatSetValuesBlocked(_matrix, 1, &row, 1, &row, block, INSERT_VALUES);
+        }
+    }
+
+    MatAssemblyBegin(_matrix, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(_matrix, MAT_FINAL_ASSEMBLY);
+    _sparsity.CheckAssembly(_matrix, "Coupled matrix");
+
+    PetscLogEventEnd(FvmLog::Event("FvmCoupledMatrix"), 0, 0, 0, 0);
+}
+
+void FvmCoupledSolver::SolveSystem(std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter) {
+    PetscLogEventBegin(FvmLog::Event("FvmCoupledSolve"), 0, 0, 0, 0);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const std::array<Vec, blockSize> fields{_fvmVar->xu, _fvmVar->xv, _fvmVar->xw, _fvmVar->xp};
+
+    // Interlace the current fields as the initial guess
+    {
+        const FieldWrite x(_x);
+        for (int c = 0; c < blockSize; ++c) {
+            const FieldRead field(fields[c]);
+            for (int i = 0; i < elementsNb; ++i)
+                x[blockSize * i + c] = field[i];
+        }
+    }
+
+    MatMult(_matrix, _x, _residual);
+    VecAYPX(_residual, -1.0, _b);
+
+    for (int c = 0; c < blockSize; ++c) {
+        PetscReal bNorm, rNorm;
+        VecStrideNorm(_residual, c, NORM_2, &rNorm);
+        VecStrideNorm(_b, c, NORM_2, &bNorm);
+        fres[c] = bNorm > SMALL ? rNorm / bNorm : rNorm;
+    }
+
+    KSPSolve(_ksp, _b, _x);
+
+    PetscInt its;
+    KSPGetIterationNumber(_ksp, &its);
+    for (int c = 0; c < blockSize; ++c)
+        fiter[c] = fvmParameter.calc[c] ? static_cast<int>(its) : 0;
+
+    {
+        const FieldRead x(_x);
+        for (int c = 0; c < blockSize; ++c) {
+            const FieldWrite field(fields[c]);
+            for (int i = 0; i < elementsNb; ++i)
+                field[i] = x[blockSize * i + c];
+        }
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmCoupledSolve"), 0, 0, 0, 0);
+}
+
+void FvmCoupledSolver::CorrectFlux() {
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+
+    // The flux the continuity rows were built with, so it is conservative; the solved
+    // fields exchange their ghosts while the interior faces are computed
+    const std::vector<Vec> solved{_fvmVar->xu, _fvmVar->xv, _fvmVar->xw, _fvmVar->xp};
+    OverlappedFaceLoop(_fvmMesh->faceSplit, solved, [&](const std::span<const int> faceList) {
+        const GhostedFieldRead rAU(_fvmVar->temp1), xp(_fvmVar->xp);
+        const GhostedFieldRead xu(_fvmVar->xu), xv(_fvmVar->xv), xw(_fvmVar->xw);
+        const GhostedFieldRead gx(_gradP[0]), gy(_gradP[1]), gz(_gradP[2]);
+        const GhostedFieldRead xuf(_fvmVar->xuf), xvf(_fvmVar->xvf), xwf(_fvmVar->xwf), xpf(_fvmVar->xpf);
+        const GhostedFieldWrite uf(_fvmVar->uf);
+
+        for (const int i: faceList) {
+            const int owner = faces.owner[i];
+            const int neighbour = Neighbour(faces, i);
+            const double s = coefficients.orientation[i];
+            const double nx = s * faces.nx[i], ny = s * faces.ny[i], nz = s * faces.nz[i];
+
+            if (neighbour != -1) {
+                const double lambda = coefficients.lambda[i];
+                const double gradient = Interpolate(gx, owner, neighbour, lambda) * nx +
+                                        Interpolate(gy, owner, neighbour, lambda) * ny +
+                                        Interpolate(gz, owner, neighbour, lambda) * nz;
+
+                uf[i] = Interpolate(xu, owner, neighbour, lambda) * nx +
+                        Interpolate(xv, owner, neighbour, lambda) * ny +
+                        Interpolate(xw, owner, neighbour, lambda) * nz -
+                        Interpolate(rAU, owner, neighbour, lambda) *
+                        ((xp[neighbour] - xp[owner]) * coefficients.inverseDistance[i] - gradient);
+                continue;
+            }
+
+            switch (GetBoundaryKind(faces.bc[i])) {
+                case BoundaryKind::VELOCITY:
+                    uf[i] = xuf[i] * nx + xvf[i] * ny + xwf[i] * nz;
+                    break;
+                case BoundaryKind::PRESSURE:
+                    uf[i] = xu[owner] * nx + xv[owner] * ny + xw[owner] * nz -
+                            rAU[owner] * ((xpf[i] - xp[owner]) * coefficients.inverseDistance[i] -
+                                          (gx[owner] * nx + gy[owner] * ny + gz[owner] * nz));
+                    break;
+                case BoundaryKind::NO_FLUX:
+                    uf[i] = 0.0;
+                    break;
+            }
+        }
+    });
+}
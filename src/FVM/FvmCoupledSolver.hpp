@@ -0,0 +1,95 @@
+#ifndef FVMCOUPLEDSOLVER_HPP
+#define FVMCOUPLEDSOLVER_HPP
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Globals.hpp"
+#include "FvmSparsity.hpp"
+#include "FvmGradient.hpp"
+#include "FvmMomentum.hpp"
+
+#include "petscksp.h"
+
+class FvmMeshContainer;
+class FvmVar;
+
+/**
+ * Fully coupled alternative to FvmFlowSolver (fvmParameter.coupled): the
+ * momentum and continuity equations of a cell form one 4x4 block row in
+ * the unknowns (u, v, w, p) and are solved together in a single block-AIJ
+ * system per iteration or time step.
+ *
+ * Momentum rows carry the coefficients of the segregated solver (FvmMomentum,
+ * with the deferred correction of the convection scheme) plus an implicit
+ * Green-Gauss pressure gradient.
+ * The continuity row takes the Rhie-Chow face velocity
+ * uf = u_f . n - (V/aP)_f ((pN - pP) / dj - grad(p)_f . n), with the
+ * cell gradient lagged from the previous iterate.
+ *
+ * The KSP defaults to FGMRES with a full Schur-complement PCFIELDSPLIT:
+ * split "u" = {0, 1, 2} and split "p" = {3}, with the Schur complement
+ * preconditioned by selfp. Everything can be overridden with -coupled_*
+ * options.
+ */
+class FvmCoupledSolver {
+public:
+    FvmCoupledSolver(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar);
+
+    ~FvmCoupledSolver();
+
+    FvmCoupledSolver(const FvmCoupledSolver &) = delete;
+
+    FvmCoupledSolver &operator=(const FvmCoupledSolver &) = delete;
+
+    //! Same contract as FvmFlowSolver::Iterate; every field reports the
+    //! iterations of the one coupled solve
+    void Iterate(double dt, std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter);
+
+    //! Scalar cell pattern and gradients, shared with the transport equations
+    [[nodiscard]] const FvmSparsity &Sparsity() const { return _sparsity; }
+
+    [[nodiscard]] const FvmGradient &GradientOperator() const { return _gradient; }
+
+private:
+    static constexpr int blockSize = 4;
+
+    //! Momentum diagonal (ap), face coefficients and source (bu, bv, bw)
+    //! through FvmMomentum; temp1 = V / aP, its ghosts left to BuildSystem
+    void BuildMomentumCoefficients(double dt);
+
+    //! Updates the ghosts of temp1 during the sweep over the interior faces
+    void BuildSystem();
+
+    //! Solved fields without ghosts; CorrectFlux updates them
+    void SolveSystem(std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter);
+
+    //! Gradient of xp into _gradP, ghosts included
+    void ComputePressureGradient();
+
+    //! Rhie-Chow face velocity of the solved fields; updates their ghosts
+    void CorrectFlux();
+
+    //! Global block index of a local cell or ghost slot
+    [[nodiscard]] PetscInt GlobalBlock(int cell) const;
+
+private:
+    std::shared_ptr<FvmMeshContainer> _fvmMesh;
+    std::shared_ptr<FvmVar> _fvmVar;
+
+    FvmSparsity _sparsity;
+    FvmGradient _gradient;
+    FvmMomentum _momentum;
+
+    Mat _matrix = nullptr;
+    Vec _x = nullptr, _b = nullptr, _residual = nullptr;
+    KSP _ksp = nullptr;
+
+    bool _pressureFixed = false; //! Some boundary fixes the pressure level
+
+    std::vector<PetscScalar> _diagonalBlocks; //! Row-major 4x4 block per cell
+    std::array<Vec, 3> _gradP{}; //! Lagged pressure gradient, ghosted like xp
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "FvmEnergySolver.hpp"
+#include "FvmMesh.hpp"
+#include "FvmVar.hpp"
+#include "FvmVector.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmLog.hpp"
+#include "FvmParam.hpp"
+#include "FvmFlowFaces.hpp"
+#include "FvmFaceLoop.hpp"
+
+#include <algorithm>
+
+using namespace FvmFlow;
+
+namespace {
+    constexpr int T = ToInt(FieldIndex::T);
+
+    //! How a boundary face enters the energy equation
+    enum class ThermalKind {
+        FIXED, // temperature xTf on the face
+        ZERO_GRADIENT, // outflow takes the cell value, inflow brings xTf
+        ADIABATIC // no convective or diffusive heat flux
+    };
+
+    ThermalKind GetThermalKind(const BndCondType bc) {
+        switch (bc) {
+            case BndCondType::ADIABATICWALL:
+            case BndCondType::SLIP:
+            case BndCondType::EMPTY:
+                return ThermalKind::ADIABATIC;
+            case BndCondType::OPEN:
+            case BndCondType::OUTLET:
+            case BndCondType::PRESSURE:
+                return ThermalKind::ZERO_GRADIENT;
+            default:
+                return ThermalKind::FIXED;
+        }
+    }
+
+    //! Temperature is taken from xTf on the face (FvmGradientField::fixed)
+    bool FixesTemperature(const BndCondType bc) {
+        return GetThermalKind(bc) == ThermalKind::FIXED;
+    }
+}
+
+FvmEnergySolver::FvmEnergySolver(const std::shared_ptr<FvmMeshContainer> &fvmMesh,
+                                 const std::shared_ptr<FvmVar> &fvmVar, const FvmSparsity &sparsity,
+                                 const FvmGradient &gradient)
+    : _fvmMesh(fvmMesh),
+      _fvmVar(fvmVar),
+      _sparsity(sparsity),
+      _gradient(gradient),
+      _steady(fvmParameter.steady == LOGICAL_TRUE) {
+    if (!_fvmVar->IsActive(FvmVar::FieldSet::ENERGY))
+        throw FvmException("Energy solver needs the energy fields (fvmParameter.calc)", LOGICAL_ERROR);
+
+    VecDuplicate(_fvmVar->xT, &_fvmVar->bT);
+    VecDuplicate(_fvmVar->xT, &_fvmVar->xTp);
+
+    _deferredCorrection = fvmParameter.scheme[T] != static_cast<int>(FvmConvection::Scheme::UPWIND) &&
+                          fvmParameter.inertia == LOGICAL_TRUE;
+    if (_deferredCorrection) {
+        _heatFlux.resize(_fvmMesh->storage.Faces().size);
+        for (auto &gradient: _gradT)
+            VecDuplicate(_fvmVar->xT, &gradient);
+    }
+
+    _sparsity.CreateScalarMatrix(&_fvmVar->Ae);
+    _coefficients.resize(_sparsity.EntriesNumber());
+
+    _solver = std::make_unique<FvmLinearSolver>(FieldIndex::T, _fvmVar->Ae, _fvmMesh.get());
+}
+
+FvmEnergySolver::~FvmEnergySolver() {
+    for (auto &gradient: _gradT) {
+        if (gradient)
+            VecDestroy(&gradient);
+    }
+}
+
+void FvmEnergySolver::Iterate(const double dt, std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter) {
+    PetscLogEventBegin(FvmLog::Event("FvmEnergyIterate"), 0, 0, 0, 0);
+
+    VecCopy(_fvmVar->xT, _fvmVar->xTp);
+
+    // Updates the ghosts of xT for the convection gradient
+    BuildMatrix(dt);
+    if (_deferredCorrection)
+        AddConvectionCorrection();
+
+    fres[T] = _solver->Solve(_fvmVar->bT, _fvmVar->xT, fiter[T]);
+    FvmVector::V_GhostUpdate({_fvmVar->xT});
+
+    PetscLogEventEnd(FvmLog::Event("FvmEnergyIterate"), 0, 0, 0, 0);
+}
+
+void FvmEnergySolver::BuildMatrix(const double dt) {
+    PetscLogEventBegin(FvmLog::Event("FvmEnergyMatrix"), 0, 0, 0, 0);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+    const auto elements = _fvmMesh->storage.Elements();
+    const Mat Ae = _fvmVar->Ae;
+
+    const double alpha = _steady ? fvmParameter.ef[T] : 1.0;
+    const bool convection = fvmParameter.inertia == LOGICAL_TRUE;
+
+    // Diagonals accumulate in the first elementsNb COO entries
+    std::fill_n(_coefficients.begin(), elementsNb, 0.0);
+
+    {
+        const FieldWrite bT(_fvmVar->bT);
+        for (int i = 0; i < elementsNb; ++i)
+            bT[i] = 0.0;
+    }
+
+    // The matrix needs no ghosts of xT: their update runs during the face loop
+    OverlappedFaceLoop(_fvmMesh->faceSplit, {_fvmVar->xT}, [&](const std::span<const int> faceList) {
+        const GhostedFieldRead dens(_fvmVar->dens), spheat(_fvmVar->spheat), thcond(_fvmVar->thcond);
+        const GhostedFieldRead uf(_fvmVar->uf), xTf(_fvmVar->xTf);
+        const FieldWrite bT(_fvmVar->bT);
+
+        for (const int i: faceList) {
+            const int owner = faces.owner[i];
+            const int neighbour = Neighbour(faces, i);
+
+            if (neighbour != -1) {
+                const double lambda = coefficients.lambda[i];
+                const double F = convection
+                                     ? Interpolate(dens, owner, neighbour, lambda) *
+                                       Interpolate(spheat, owner, neighbour, lambda) * uf[i] * faces.Aj[i]
+                                     : 0.0;
+                const double D = Interpolate(thcond, owner, neighbour, lambda) * coefficients.diffusion[i];
+
+                if (_deferredCorrection)
+                    _heatFlux[i] = F;
+
+                // Implicit upwind convection and central diffusion
+                _coefficients[owner] += LMAX(F, 0.0) + D;
+                _coefficients[_sparsity.OwnerEntry(i)] = LMIN(F, 0.0) - D;
+
+                if (neighbour < elementsNb) {
+                    _coefficients[neighbour] += LMAX(-F, 0.0) + D;
+                    _coefficients[_sparsity.NeighbourEntry(i)] = -LMAX(F, 0.0) - D;
+                }
+                continue;
+            }
+
+            if (_deferredCorrection)
+                _heatFlux[i] = 0.0;
+
+            const ThermalKind kind = GetThermalKind(faces.bc[i]);
+            if (kind == ThermalKind::ADIABATIC)
+                continue;
+
+            const double F = convection ? dens[owner] * spheat[owner] * uf[i] * faces.Aj[i] : 0.0;
+
+            // Inflow carries the boundary temperature in
+            double coefficient = -LMIN(F, 0.0);
+            _coefficients[owner] += LMAX(F, 0.0);
+
+            if (kind == ThermalKind::FIXED) {
+                const double D = thcond[owner] * coefficients.diffusion[i];
+                _coefficients[owner] += D;
+                coefficient += D;
+            }
+
+            bT[owner] += coefficient * xTf[i];
+        }
+    });
+
+    {
+        const GhostedFieldRead dens(_fvmVar->dens), spheat(_fvmVar->spheat);
+        const FieldRead xT(_fvmVar->xT), xT0(_fvmVar->xT0);
+        const FieldWrite bT(_fvmVar->bT);
+
+        for (int i = 0; i < elementsNb; ++i) {
+            if (!_steady) {
+                const double inertia = dens[i] * spheat[i] * elements.Vp[i] / dt;
+                _coefficients[i] += inertia;
+                bT[i] += inertia * xT0[i];
+            }
+
+            // Under-relaxation: aP / ef with the previous value as source
+            const double ap = _coefficients[i] / alpha;
+            bT[i] += (ap - _coefficients[i]) * xT[i];
+            _coefficients[i] = ap;
+        }
+    }
+
+    _sparsity.SetValues(Ae, _coefficients);
+    _sparsity.CheckAssembly(Ae, "Energy matrix");
+    _solver->MatrixUpdated();
+
+    PetscLogEventEnd(FvmLog::Event("FvmEnergyMatrix"), 0, 0, 0, 0);
+}
+
+void FvmEnergySolver::AddConvectionCorrection() {
+    PetscLogEventBegin(FvmLog::Event("FvmConvection"), 0, 0, 0, 0);
+
+    _gradient.Compute({{_fvmVar->xT, _fvmVar->xTf, FixesTemperature, _gradT}});
+
+    {
+        const GhostedFieldRead phi(_fvmVar->xT);
+        const GhostedFieldRead gx(_gradT[0]), gy(_gradT[1]), gz(_gradT[2]);
+        const FieldWrite bT(_fvmVar->bT);
+
+        FvmConvection::AddDeferredCorrection(static_cast<FvmConvection::Scheme>(fvmParameter.scheme[T]),
+                                             _gradient.Stencil(), _heatFlux.data(), phi.Data(), gx.Data(),
+                                             gy.Data(), gz.Data(), bT.Data(), fvmParameter.blend, fvmParameter.kq);
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmConvection"), 0, 0, 0, 0);
+}
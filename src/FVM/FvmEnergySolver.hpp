@@ -0,0 +1,68 @@
+#ifndef FVMENERGYSOLVER_HPP
+#define FVMENERGYSOLVER_HPP
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Globals.hpp"
+#include "FvmSparsity.hpp"
+#include "FvmLinearSolver.hpp"
+#include "FvmGradient.hpp"
+
+#include "petscksp.h"
+
+class FvmMeshContainer;
+class FvmVar;
+
+/**
+ * Implicit temperature transport
+ *   d(dens cp T)/dt + div(dens cp uf T) = div(thcond grad T)
+ * on the face fluxes left by the flow solver. It borrows the cell pattern
+ * (FvmSparsity) and the gradient operator of the flow solver: Ae only
+ * registers the existing COO list and is refilled in place every step,
+ * so heat transfer adds one scalar assembly and one KSP solve (prefix T_).
+ *
+ * Convection is implicit upwind with the scheme of fvmParameter.scheme[T]
+ * as a deferred correction (FvmConvection); diffusion is central with the
+ * face coefficients of FvmMeshStorage.
+ */
+class FvmEnergySolver {
+public:
+    FvmEnergySolver(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar,
+                    const FvmSparsity &sparsity, const FvmGradient &gradient);
+
+    ~FvmEnergySolver();
+
+    FvmEnergySolver(const FvmEnergySolver &) = delete;
+
+    FvmEnergySolver &operator=(const FvmEnergySolver &) = delete;
+
+    //! One steady iteration (under-relaxed with ef[T]) or one time step dt;
+    //! fills fres[T] and fiter[T]
+    void Iterate(double dt, std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter);
+
+private:
+    void BuildMatrix(double dt);
+
+    //! Explicit part of the convection scheme of T in bT
+    void AddConvectionCorrection();
+
+private:
+    std::shared_ptr<FvmMeshContainer> _fvmMesh;
+    std::shared_ptr<FvmVar> _fvmVar;
+
+    const FvmSparsity &_sparsity;
+    const FvmGradient &_gradient;
+
+    std::unique_ptr<FvmLinearSolver> _solver;
+
+    bool _steady = false;
+    bool _deferredCorrection = false; //! scheme[T] is not upwind
+
+    std::vector<PetscScalar> _coefficients; //! COO values of Ae
+    std::vector<double> _heatFlux; //! dens_f cp_f uf Aj of the last assembly (0 on boundaries)
+    std::array<Vec, 3> _gradT{}; //! Temperature gradient, ghosted like xT
+};
+
+#endif
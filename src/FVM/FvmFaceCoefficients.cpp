@@ -0,0 +1,113 @@
+#include "FvmFaceCoefficients.hpp"
+
+#include <string>
+
+#include "Globals.hpp"
+
+using namespace FvmMesh;
+
+void FvmFaceCoefficients::Build(const FvmMeshStorage &storage) {
+    const auto faces = storage.Faces();
+    const auto elements = storage.Elements();
+
+    const std::size_t facesNb = faces.size;
+    for (auto *v: {&lambda, &orientation, &dj, &kj, &inverseDistance, &diffusion, &ox, &oy, &oz, &px, &py, &pz})
+        v->assign(facesNb, 0.0);
+
+    for (std::size_t i = 0; i < facesNb; ++i) {
+        const int P = faces.owner[i];
+        const double nx = faces.nx[i], ny = faces.ny[i], nz = faces.nz[i];
+        const double rx = faces.cx[i] - elements.cx[P], ry = faces.cy[i] - elements.cy[P],
+                rz = faces.cz[i] - elements.cz[P];
+        const double fn = rx * nx + ry * ny + rz * nz;
+
+        // rpl - cP: the owner offset normal to n
+        ox[i] = rx - fn * nx;
+        oy[i] = ry - fn * ny;
+        oz[i] = rz - fn * nz;
+
+        // Signed length of rnl - rpl (of cf - rpl on boundaries) along n
+        double dn = fn;
+        if (faces.pair[i] != -1) {
+            // Interior normals already point to the pair
+            const int N = faces.pair[i];
+            const double sx = faces.cx[i] - elements.cx[N], sy = faces.cy[i] - elements.cy[N],
+                    sz = faces.cz[i] - elements.cz[N];
+            const double sn = sx * nx + sy * ny + sz * nz;
+            dn = fn - sn;
+
+            orientation[i] = 1.0;
+            lambda[i] = LABS(dn) < VSMALL ? 0.5 : LMIN(LMAX(fn / dn, 0.0), 1.0);
+            px[i] = sx - sn * nx;
+            py[i] = sy - sn * ny;
+            pz[i] = sz - sn * nz;
+        } else {
+            orientation[i] = fn < 0.0 ? -1.0 : 1.0;
+        }
+
+        if (LABS(dn) < VSMALL)
+            throw FvmException("Invalid mesh (face " + std::to_string(i) + ": zero normal distance)", LOGICAL_ERROR);
+
+        dj[i] = LABS(dn);
+        kj[i] = faces.Aj[i] * dn;
+        inverseDistance[i] = 1.0 / dj[i];
+        diffusion[i] = faces.Aj[i] * inverseDistance[i];
+    }
+}
+
+void FvmFaceCoefficients::BuildGhost(const FvmMeshStorage &storage, const std::span<const double> cx,
+                                     const std::span<const double> cy, const std::span<const double> cz) {
+    const auto faces = storage.Faces();
+
+    for (int i = 0; i < faces.size; ++i) {
+        const int P = faces.owner[i];
+        const int N = faces.ghost[i];
+        if (N < 0 || static_cast<std::size_t>(N) >= cx.size())
+            continue;
+
+        // Outward normal of the owner, as on interior faces
+        const double s = orientation[i];
+        const double mx = s * faces.nx[i], my = s * faces.ny[i], mz = s * faces.nz[i];
+
+        const double fn = (faces.cx[i] - cx[P]) * mx + (faces.cy[i] - cy[P]) * my + (faces.cz[i] - cz[P]) * mz;
+        const double sx = faces.cx[i] - cx[N], sy = faces.cy[i] - cy[N], sz = faces.cz[i] - cz[N];
+        const double sn = sx * mx + sy * my + sz * mz;
+        const double dn = fn - sn;
+        if (LABS(dn) < VSMALL)
+            continue;
+
+        lambda[i] = LMIN(LMAX(fn / dn, 0.0), 1.0);
+        px[i] = sx - sn * mx;
+        py[i] = sy - sn * my;
+        pz[i] = sz - sn * mz;
+        dj[i] = LABS(dn);
+        kj[i] = s * faces.Aj[i] * dn;
+        inverseDistance[i] = 1.0 / dj[i];
+        diffusion[i] = faces.Aj[i] * inverseDistance[i];
+    }
+}
+
+FaceCoefficientView FvmFaceCoefficients::View() const {
+    FaceCoefficientView view;
+    view.size = static_cast<int>(lambda.size());
+    view.lambda = lambda;
+    view.orientation = orientation;
+    view.dj = dj;
+    view.kj = kj;
+    view.inverseDistance = inverseDistance;
+    view.diffusion = diffusion;
+    view.ox = ox;
+    view.oy = oy;
+    view.oz = oz;
+    view.px = px;
+    view.py = py;
+    view.pz = pz;
+    return view;
+}
+
+std::size_t FvmFaceCoefficients::MemoryBytes() const {
+    return VectorBytes(lambda) + VectorBytes(orientation) + VectorBytes(dj) + VectorBytes(kj) +
+           VectorBytes(inverseDistance) + VectorBytes(diffusion) +
+           VectorBytes(ox) + VectorBytes(oy) + VectorBytes(oz) +
+           VectorBytes(px) + VectorBytes(py) + VectorBytes(pz);
+}
@@ -0,0 +1,61 @@
+#ifndef FVMFACECOEFFICIENTS_HPP
+#define FVMFACECOEFFICIENTS_HPP
+
+#include <cstddef>
+#include <span>
+
+#include "FvmMeshStorage.hpp"
+
+namespace FvmMesh {
+    /**
+     * Read-only face coefficients, computed once from the face geometry.
+     * The surface vector aVec = Aj n is split into an orthogonal part, a
+     * central difference between rpl and rnl (the centres projected on the
+     * face normal) scaled by diffusion = Aj / |rnl - rpl|, and a
+     * non-orthogonal remainder carried by the offsets rpl - cP and rnl - cN.
+     * Boundary faces measure the distance from rpl to the face centre.
+     */
+    struct FaceCoefficientView {
+        int size = 0;
+
+        std::span<const double> lambda; //! Neighbour weight of the linear interpolation (0 on boundaries)
+        std::span<const double> orientation; //! +1 or -1 turning the stored normal outward of the owner
+        std::span<const double> dj; //! |rnl - rpl|
+        std::span<const double> kj; //! aVec . (rnl - rpl), signed by the stored normal
+        std::span<const double> inverseDistance; //! 1 / |rnl - rpl|
+        std::span<const double> diffusion; //! Aj / |rnl - rpl|
+        std::span<const double> ox, oy, oz; //! rpl - owner centre
+        std::span<const double> px, py, pz; //! rnl - neighbour centre (0 on boundaries)
+    };
+}
+
+/**
+ * Face coefficient cache of the interpolation, diffusion and flux kernels,
+ * in aligned arrays indexed like the faces of FvmMeshStorage. Processor
+ * faces count as boundaries until BuildGhost has the ghost cell centres.
+ */
+class FvmFaceCoefficients {
+public:
+    void Build(const FvmMeshStorage &storage);
+
+    //! Completes the coefficients of processor faces from the ghosted cell
+    //! centres (owned cells then ghost slots). Run after the centre exchange.
+    void BuildGhost(const FvmMeshStorage &storage, std::span<const double> cx, std::span<const double> cy,
+                    std::span<const double> cz);
+
+    [[nodiscard]] FvmMesh::FaceCoefficientView View() const;
+
+    [[nodiscard]] std::size_t MemoryBytes() const;
+
+public:
+    FvmMesh::AlignedVector<double> lambda;
+    FvmMesh::AlignedVector<double> orientation;
+    FvmMesh::AlignedVector<double> dj;
+    FvmMesh::AlignedVector<double> kj;
+    FvmMesh::AlignedVector<double> inverseDistance;
+    FvmMesh::AlignedVector<double> diffusion;
+    FvmMesh::AlignedVector<double> ox, oy, oz;
+    FvmMesh::AlignedVector<double> px, py, pz;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef FVMFACELOOP_HPP
+#define FVMFACELOOP_HPP
+
+#include "FvmFaceSplit.hpp"
+#include "FvmVector.hpp"
+
+#include <span>
+#include <vector>
+
+/**
+ * Face loop overlapped with the ghost update of fields. kernel(faces) is
+ * called with the interior faces while the fused exchange is in flight,
+ * then with the processor faces once the ghost values have arrived. The
+ * kernel should open its field views inside each call.
+ */
+template<typename Kernel>
+void OverlappedFaceLoop(const FvmFaceSplit &split, const std::vector<Vec> &fields, Kernel &&kernel) {
+    if (fields.empty()) {
+        kernel(std::span<const int>(split.interiorFaces));
+        kernel(std::span<const int>(split.interfaceFaces));
+        return;
+    }
+
+    FvmVector::V_GhostUpdateBegin(fields);
+    kernel(std::span<const int>(split.interiorFaces));
+    FvmVector::V_GhostUpdateEnd(fields);
+
+    kernel(std::span<const int>(split.interfaceFaces));
+}
+
+#endif
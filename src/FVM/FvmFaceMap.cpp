@@ -0,0 +1,143 @@
+#include "FvmFaceMap.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+using namespace FvmMesh;
+
+namespace {
+    constexpr std::size_t MIN_CAPACITY = 16;
+
+    // Keep load factor below 0.7
+    constexpr std::size_t MAX_LOAD_NUM = 7;
+    constexpr std::size_t MAX_LOAD_DEN = 10;
+
+    std::uint64_t Mix(std::uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    std::size_t CapacityFor(const std::size_t keys) {
+        const std::size_t needed = keys * MAX_LOAD_DEN / MAX_LOAD_NUM + 1;
+        return std::bit_ceil(std::max(needed, MIN_CAPACITY));
+    }
+
+    bool IsEmpty(const FaceKey &key) {
+        return key.v[0] == -1;
+    }
+}
+
+FaceKey FvmMesh::MakeFaceKey(const int *verts, const int n) {
+    if (n < 1 || n > MAX_FACE_NODES)
+        throw std::runtime_error("Unsupported number of face vertices");
+
+    FaceKey key;
+    std::copy_n(verts, n, key.v.begin());
+
+    // Sorting network for up to four vertices (-1 padding stays at the end)
+    auto order = [&key](const int i, const int j) {
+        if (key.v[j] != -1 && key.v[j] < key.v[i])
+            std::swap(key.v[i], key.v[j]);
+    };
+    order(0, 1);
+    order(2, 3);
+    order(0, 2);
+    order(1, 3);
+    order(1, 2);
+
+    return key;
+}
+
+std::uint64_t FvmMesh::HashFaceKey(const FaceKey &key) {
+    const std::uint64_t lo = static_cast<std::uint32_t>(key.v[0]) |
+                             static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.v[1])) << 32;
+    const std::uint64_t hi = static_cast<std::uint32_t>(key.v[2]) |
+                             static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.v[3])) << 32;
+
+    return Mix(lo ^ Mix(hi));
+}
+
+FaceKey FvmMesh::MakeFaceKey(const FaceVertices &verts) {
+    return MakeFaceKey(verts.v.data(), verts.n);
+}
+
+FaceHashMap::FaceHashMap(const std::size_t expectedKeys) {
+    const std::size_t capacity = CapacityFor(expectedKeys);
+    _entries.assign(capacity, Entry{});
+    _mask = capacity - 1;
+}
+
+std::size_t FaceHashMap::Slot(const FaceKey &key) const {
+    return static_cast<std::size_t>(HashFaceKey(key)) & _mask;
+}
+
+std::pair<int, bool> FaceHashMap::TryEmplace(const FaceKey &key, const int value) {
+    if ((_size + 1) * MAX_LOAD_DEN > _entries.size() * MAX_LOAD_NUM)
+        Rehash(_entries.size() * 2);
+
+    std::size_t slot = Slot(key);
+    while (!IsEmpty(_entries[slot].key)) {
+        if (_entries[slot].key == key)
+            return {_entries[slot].value, false};
+        slot = (slot + 1) & _mask;
+    }
+
+    _entries[slot] = {key, value};
+    ++_size;
+
+    return {value, true};
+}
+
+void FaceHashMap::InsertOrAssign(const FaceKey &key, const int value) {
+    if ((_size + 1) * MAX_LOAD_DEN > _entries.size() * MAX_LOAD_NUM)
+        Rehash(_entries.size() * 2);
+
+    std::size_t slot = Slot(key);
+    while (!IsEmpty(_entries[slot].key)) {
+        if (_entries[slot].key == key) {
+            _entries[slot].value = value;
+            return;
+        }
+        slot = (slot + 1) & _mask;
+    }
+
+    _entries[slot] = {key, value};
+    ++_size;
+}
+
+int FaceHashMap::Find(const FaceKey &key) const {
+    std::size_t slot = Slot(key);
+    while (!IsEmpty(_entries[slot].key)) {
+        if (_entries[slot].key == key)
+            return _entries[slot].value;
+        slot = (slot + 1) & _mask;
+    }
+
+    return -1;
+}
+
+std::size_t FaceHashMap::MemoryBytes() const {
+    return _entries.capacity() * sizeof(Entry);
+}
+
+void FaceHashMap::Rehash(const std::size_t capacity) {
+    std::vector<Entry> oldEntries(capacity, Entry{});
+    oldEntries.swap(_entries);
+    _mask = capacity - 1;
+
+    for (const auto &entry: oldEntries) {
+        if (IsEmpty(entry.key))
+            continue;
+
+        std::size_t slot = Slot(entry.key);
+        while (!IsEmpty(_entries[slot].key))
+            slot = (slot + 1) & _mask;
+
+        _entries[slot] = entry;
+    }
+}
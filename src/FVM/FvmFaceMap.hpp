@@ -0,0 +1,75 @@
+#ifndef FVMFACEMAP_HPP
+#define FVMFACEMAP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FvmMesh {
+    constexpr int MAX_FACE_NODES = 4;
+
+    //! Face vertices in element order (orientation preserved)
+    struct FaceVertices {
+        std::array<int, MAX_FACE_NODES> v{-1, -1, -1, -1};
+        int n = 0;
+    };
+
+    //! Orientation independent face key: vertices sorted ascending,
+    //! unused slots padded with -1
+    struct FaceKey {
+        std::array<int, MAX_FACE_NODES> v{-1, -1, -1, -1};
+
+        bool operator==(const FaceKey &other) const = default;
+    };
+
+    FaceKey MakeFaceKey(const FaceVertices &verts);
+
+    FaceKey MakeFaceKey(const int *verts, int n);
+
+    std::uint64_t HashFaceKey(const FaceKey &key);
+}
+
+/**
+ * Open addressing (linear probing) hash table mapping face keys to
+ * integer values. Used to match faces shared by two cells without
+ * allocating a node-based container entry per face.
+ *
+ * The home slot hashes the whole sorted key uniformly over the table, so
+ * probe lengths do not depend on how the mesh generator numbers vertices.
+ */
+class FaceHashMap {
+public:
+    explicit FaceHashMap(std::size_t expectedKeys);
+
+    //! Inserts key -> value if key is absent. Returns stored value and
+    //! whether the insertion took place.
+    std::pair<int, bool> TryEmplace(const FvmMesh::FaceKey &key, int value);
+
+    //! Inserts key -> value, overwriting an existing value.
+    void InsertOrAssign(const FvmMesh::FaceKey &key, int value);
+
+    //! Returns stored value or -1 if key is absent.
+    [[nodiscard]] int Find(const FvmMesh::FaceKey &key) const;
+
+    [[nodiscard]] std::size_t Size() const { return _size; }
+    [[nodiscard]] std::size_t Capacity() const { return _entries.size(); }
+    [[nodiscard]] std::size_t MemoryBytes() const;
+
+private:
+    [[nodiscard]] std::size_t Slot(const FvmMesh::FaceKey &key) const;
+
+    void Rehash(std::size_t capacity);
+
+private:
+    struct Entry {
+        FvmMesh::FaceKey key;
+        int value = -1;
+    };
+
+    std::vector<Entry> _entries;
+    std::size_t _mask = 0;
+    std::size_t _size = 0;
+};
+
+#endif
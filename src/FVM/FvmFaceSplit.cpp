@@ -0,0 +1,20 @@
+#include "FvmFaceSplit.hpp"
+
+using namespace FvmMesh;
+
+void FvmFaceSplit::Build(const FvmMeshStorage &storage) {
+    const auto faces = storage.Faces();
+    interiorFaces.clear();
+    interfaceFaces.clear();
+
+    for (int i = 0; i < faces.size; ++i) {
+        if (faces.pair[i] == -1 && faces.bc[i] == BndCondType::PROCESSOR)
+            interfaceFaces.push_back(i);
+        else
+            interiorFaces.push_back(i);
+    }
+}
+
+std::size_t FvmFaceSplit::MemoryBytes() const {
+    return VectorBytes(interiorFaces) + VectorBytes(interfaceFaces);
+}
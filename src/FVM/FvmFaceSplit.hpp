@@ -0,0 +1,25 @@
+#ifndef FVMFACESPLIT_HPP
+#define FVMFACESPLIT_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "FvmMeshStorage.hpp"
+
+/**
+ * Faces split by whether they need ghost values: OverlappedFaceLoop runs
+ * the interior list while the ghost update is in flight and the processor
+ * faces after it. Rebuild when processor faces or ghost slots change.
+ */
+class FvmFaceSplit {
+public:
+    void Build(const FvmMeshStorage &storage);
+
+    [[nodiscard]] std::size_t MemoryBytes() const;
+
+public:
+    std::vector<int> interiorFaces; //! All faces but processor faces
+    std::vector<int> interfaceFaces; //! Processor faces
+};
+
+#endif
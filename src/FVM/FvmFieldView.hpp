@@ -0,0 +1,91 @@
+#ifndef FVMFIELDVIEW_HPP
+#define FVMFIELDVIEW_HPP
+
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include "Globals.hpp"
+
+#include "petscvec.h"
+
+enum class FieldAccess { Read, Write };
+
+/**
+ * RAII access to the local array of a PETSc vector (VecGetArray /
+ * VecGetArrayRead). Owned entries are 0 ... Size() - 1; a Ghosted view maps
+ * the local form of a VecCreateGhost vector, so ghost entries follow the
+ * owned ones. The array is restored when the view goes out of scope.
+ * Indices are bounds-checked unless NDEBUG is defined.
+ *
+ * Writes through a view bypass the assembly stash: no VecAssembly is
+ * needed, only a VecGhostUpdate when ghost values must be refreshed.
+ */
+template<FieldAccess Access, bool Ghosted = false>
+class FieldView {
+public:
+    using value_type = std::conditional_t<Access == FieldAccess::Read, const PetscScalar, PetscScalar>;
+
+    explicit FieldView(const Vec vec)
+        : _vec(vec), _target(vec) {
+        if constexpr (Ghosted) {
+            VecGhostGetLocalForm(vec, &_local);
+            if (_local)
+                _target = _local;
+        }
+
+        if constexpr (Access == FieldAccess::Read) {
+            VecGetArrayRead(_target, &_array);
+        } else {
+            VecGetArray(_target, &_array);
+        }
+        VecGetLocalSize(_target, &_size);
+    }
+
+    ~FieldView() {
+        if constexpr (Access == FieldAccess::Read) {
+            VecRestoreArrayRead(_target, &_array);
+        } else {
+            VecRestoreArray(_target, &_array);
+        }
+
+        if constexpr (Ghosted) {
+            if (_local)
+                VecGhostRestoreLocalForm(_vec, &_local);
+        }
+    }
+
+    FieldView(const FieldView &) = delete;
+
+    FieldView &operator=(const FieldView &) = delete;
+
+    value_type &operator[](const PetscInt i) const {
+#ifndef NDEBUG
+        if (i < 0 || i >= _size) {
+            throw FvmException("Field view index " + std::to_string(i) +
+                               " out of range [0, " + std::to_string(_size) + ")", LOGICAL_ERROR);
+        }
+#endif
+        return _array[i];
+    }
+
+    [[nodiscard]] PetscInt Size() const { return _size; }
+
+    [[nodiscard]] value_type *Data() const { return _array; }
+
+    [[nodiscard]] std::span<value_type> Span() const { return {_array, static_cast<std::size_t>(_size)}; }
+
+private:
+    Vec _vec;
+    Vec _local = nullptr;
+    Vec _target;
+    value_type *_array = nullptr;
+    PetscInt _size = 0;
+};
+
+using FieldRead = FieldView<FieldAccess::Read>;
+using FieldWrite = FieldView<FieldAccess::Write>;
+using GhostedFieldRead = FieldView<FieldAccess::Read, true>;
+using GhostedFieldWrite = FieldView<FieldAccess::Write, true>;
+
+#endif
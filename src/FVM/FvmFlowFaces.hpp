@@ -0,0 +1,62 @@
+#ifndef FVMFLOWFACES_HPP
+#define FVMFLOWFACES_HPP
+
+#include "FvmMesh.hpp"
+#include "FvmFieldView.hpp"
+#include "Globals.hpp"
+
+/**
+ * Face helpers shared by the segregated and coupled flow solvers: boundary
+ * classification, neighbour slots and linear interpolation. The weights
+ * are the face coefficients of FvmMeshStorage.
+ */
+namespace FvmFlow {
+    using FvmMesh::FaceView;
+
+    //! How a boundary face enters the momentum and pressure equations
+    enum class BoundaryKind {
+        VELOCITY, // fixed velocity (xuf), zero pressure gradient
+        PRESSURE, // fixed pressure (xpf), zero velocity gradient
+        NO_FLUX // no mass flux and no shear
+    };
+
+    inline BoundaryKind GetBoundaryKind(const BndCondType bc) {
+        switch (bc) {
+            case BndCondType::EMPTY:
+            case BndCondType::SLIP:
+                return BoundaryKind::NO_FLUX;
+            case BndCondType::OPEN:
+            case BndCondType::PRESSUREINLET:
+            case BndCondType::OUTLET:
+            case BndCondType::PRESSURE:
+                return BoundaryKind::PRESSURE;
+            default:
+                return BoundaryKind::VELOCITY;
+        }
+    }
+
+    //! Pair cell, ghost slot of a processor face, or -1 on boundaries
+    inline int Neighbour(const FaceView &faces, const int i) {
+        return faces.pair[i] != -1 ? faces.pair[i] : faces.ghost[i];
+    }
+
+    struct Centres {
+        const GhostedFieldRead x, y, z;
+    };
+
+    //! Ghosted read views of the three components of a cell gradient
+    struct Gradient {
+        const GhostedFieldRead x, y, z;
+    };
+
+    inline double Interpolate(const GhostedFieldRead &field, const int owner, const int neighbour, const double lambda) {
+        return field[owner] * (1.0 - lambda) + field[neighbour] * lambda;
+    }
+
+    //! Pressure is taken from xpf on the face (FvmGradientField::fixed)
+    inline bool FixesPressure(const BndCondType bc) {
+        return GetBoundaryKind(bc) == BoundaryKind::PRESSURE;
+    }
+}
+
+#endif
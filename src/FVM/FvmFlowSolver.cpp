@@ -0,0 +1,435 @@
+#include "FvmFlowSolver.hpp"
+#include "FvmMesh.hpp"
+#include "FvmVar.hpp"
+#include "FvmVector.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmLog.hpp"
+#include "FvmParam.hpp"
+#include "FvmSparsity.hpp"
+#include "FvmFlowFaces.hpp"
+#include "FvmFaceLoop.hpp"
+
+#include <algorithm>
+
+using namespace FvmMesh;
+using namespace FvmFlow;
+
+namespace {
+    constexpr int U = ToInt(FieldIndex::U);
+    constexpr int V = ToInt(FieldIndex::V);
+    constexpr int W = ToInt(FieldIndex::W);
+    constexpr int P = ToInt(FieldIndex::P);
+}
+
+FvmFlowSolver::FvmFlowSolver(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar)
+    : _fvmMesh(fvmMesh),
+      _fvmVar(fvmVar),
+      _sparsity(*fvmMesh),
+      _gradient(fvmMesh, fvmVar),
+      _momentum(fvmMesh, fvmVar, _gradient),
+      _steady(fvmParameter.steady == LOGICAL_TRUE) {
+    if (!_fvmVar->IsActive(FvmVar::FieldSet::FLOW))
+        throw FvmException("Flow solver needs the flow fields (fvmParameter.calc)", LOGICAL_ERROR);
+
+    VecDuplicate(_fvmVar->xu, &_fvmVar->bu);
+    VecDuplicate(_fvmVar->xv, &_fvmVar->bv);
+    VecDuplicate(_fvmVar->xw, &_fvmVar->bw);
+    VecDuplicate(_fvmVar->xp, &_fvmVar->bp);
+    VecDuplicate(_fvmVar->xp, &_fvmVar->xpp);
+    for (auto &gradient: _gradP)
+        VecDuplicate(_fvmVar->xp, &gradient);
+
+    _sparsity.CreateScalarMatrix(&_fvmVar->Am);
+    _sparsity.CreateScalarMatrix(&_fvmVar->Ac);
+    _coefficients.resize(_sparsity.EntriesNumber());
+
+    // Boundary and mesh properties deciding the pressure equation
+    int flags[2] = {0, 0};
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+    for (int i = 0; i < faces.size; ++i) {
+        if (Neighbour(faces, i) == -1) {
+            if (GetBoundaryKind(faces.bc[i]) == BoundaryKind::PRESSURE)
+                flags[0] = 1;
+            continue;
+        }
+
+        const double offset = LABS(coefficients.ox[i]) + LABS(coefficients.oy[i]) + LABS(coefficients.oz[i]) +
+                              LABS(coefficients.px[i]) + LABS(coefficients.py[i]) + LABS(coefficients.pz[i]);
+        if (offset * coefficients.inverseDistance[i] > 1e-6)
+            flags[1] = 1;
+    }
+
+    int globalFlags[2];
+    MPI_Allreduce(flags, globalFlags, 2, MPI_INT, MPI_MAX, PETSC_COMM_WORLD);
+    _pressureFixed = globalFlags[0] == 1;
+    _nonOrthogonal = globalFlags[1] == 1;
+
+    if (!_pressureFixed) {
+        // Closed domain: the pressure is defined up to a constant
+        MatNullSpace nullSpace;
+        MatNullSpaceCreate(PETSC_COMM_WORLD, PETSC_TRUE, 0, nullptr, &nullSpace);
+        MatSetNullSpace(_fvmVar->Ac, nullSpace);
+        MatNullSpaceDestroy(&nullSpace);
+    }
+
+    _momentumSolver = std::make_unique<FvmLinearSolver>(FieldIndex::U, _fvmVar->Am);
+    _pressureSolver = std::make_unique<FvmLinearSolver>(FieldIndex::P, _fvmVar->Ac, _fvmMesh.get());
+
+    PetscPrintf(PETSC_COMM_WORLD, "\nFlow solver: %s, %s mesh, pressure level %s\n",
+                _steady ? "SIMPLE" : "PISO",
+                _nonOrthogonal ? "non-orthogonal" : "orthogonal",
+                _pressureFixed ? "fixed by boundaries" : "floating");
+}
+
+FvmFlowSolver::~FvmFlowSolver() {
+    for (auto &gradient: _gradP) {
+        if (gradient)
+            VecDestroy(&gradient);
+    }
+}
+
+void FvmFlowSolver::Iterate(const double dt, std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter) {
+    PetscLogEventBegin(FvmLog::Event("FvmFlowIterate"), 0, 0, 0, 0);
+
+    FvmVector::V_GhostUpdate({_fvmVar->xu, _fvmVar->xv, _fvmVar->xw, _fvmVar->xp});
+    VecCopy(_fvmVar->xp, _fvmVar->xpp);
+
+    BuildMomentumMatrix(dt);
+    SolveMomentum(fres, fiter);
+
+    ComputeHbyA();
+    BuildPressureMatrix();
+
+    const int correctors = _steady ? 1 : LMAX(fvmParameter.npisocor, 1);
+    const int nonOrthogonalCorrectors = _nonOrthogonal ? LMAX(fvmParameter.northocor, 0) : 0;
+
+    fiter[P] = 0;
+    for (int corrector = 0; corrector < correctors; ++corrector) {
+        // PISO: H of the corrected velocity
+        if (corrector > 0)
+            ComputeHbyA();
+
+        for (int k = 0; k <= nonOrthogonalCorrectors; ++k) {
+            BuildPressureSource(k > 0, corrector > 0 && k == 0);
+
+            int iterations;
+            const double residual = SolvePressure(iterations);
+            if (corrector == 0 && k == 0)
+                fres[P] = residual;
+            fiter[P] += iterations;
+
+            // The ghosts of xp go with the next face loop over it
+            if (k < nonOrthogonalCorrectors)
+                ComputePressureGradient(true);
+        }
+
+        // The last source used the gradient still held in _gradP
+        CorrectFlux(nonOrthogonalCorrectors > 0);
+
+        if (_steady) {
+            // p = pp + ef (p - pp); the flux keeps the unrelaxed pressure
+            const double alpha = fvmParameter.ef[P];
+            VecAXPBY(_fvmVar->xp, 1.0 - alpha, alpha, _fvmVar->xpp);
+            FvmVector::V_GhostUpdate({_fvmVar->xp});
+        }
+
+        CorrectVelocity();
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmFlowIterate"), 0, 0, 0, 0);
+}
+
+void FvmFlowSolver::BuildMomentumMatrix(const double dt) {
+    PetscLogEventBegin(FvmLog::Event("FvmMomentumMatrix"), 0, 0, 0, 0);
+
+    _momentum.Assemble(dt);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+
+    // Diagonals are the first elementsNb COO entries
+    {
+        const FieldRead ap(_fvmVar->ap);
+        for (int i = 0; i < elementsNb; ++i)
+            _coefficients[i] = ap[i];
+    }
+
+    for (int i = 0; i < faces.size; ++i) {
+        const int neighbour = Neighbour(faces, i);
+        if (neighbour == -1)
+            continue;
+
+        _coefficients[_sparsity.OwnerEntry(i)] = _momentum.OwnerCoefficient(i);
+        if (neighbour < elementsNb)
+            _coefficients[_sparsity.NeighbourEntry(i)] = _momentum.NeighbourCoefficient(i);
+    }
+
+    _sparsity.SetValues(_fvmVar->Am, _coefficients);
+    _sparsity.CheckAssembly(_fvmVar->Am, "Momentum matrix");
+    _momentumSolver->MatrixUpdated();
+
+    PetscLogEventEnd(FvmLog::Event("FvmMomentumMatrix"), 0, 0, 0, 0);
+}
+
+void FvmFlowSolver::SolveMomentum(std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter) {
+    PetscLogEventBegin(FvmLog::Event("FvmMomentumSolve"), 0, 0, 0, 0);
+
+    ComputePressureGradient();
+
+    const auto elements = _fvmMesh->storage.Elements();
+    const std::array<Vec, 3> b{_fvmVar->bu, _fvmVar->bv, _fvmVar->bw};
+    const std::array<Vec, 3> x{_fvmVar->xu, _fvmVar->xv, _fvmVar->xw};
+    for (const int c: {U, V, W}) {
+        if (!fvmParameter.calc[c]) {
+            fres[c] = 0.0;
+            fiter[c] = 0;
+            continue;
+        }
+
+        // Predictor source: b - V grad(p)
+        {
+            const FieldRead bc(b[c]), gradP(_gradP[c]);
+            const FieldWrite rhs(_fvmVar->temp2);
+            for (int i = 0; i < elements.size; ++i)
+                rhs[i] = bc[i] - elements.Vp[i] * gradP[i];
+        }
+
+        fres[c] = _momentumSolver->Solve(_fvmVar->temp2, x[c], fiter[c]);
+    }
+
+    FvmVector::V_GhostUpdate({_fvmVar->xu, _fvmVar->xv, _fvmVar->xw});
+
+    PetscLogEventEnd(FvmLog::Event("FvmMomentumSolve"), 0, 0, 0, 0);
+}
+
+void FvmFlowSolver::ComputeHbyA() {
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto elements = _fvmMesh->storage.Elements();
+
+    const std::array<Vec, 3> b{_fvmVar->bu, _fvmVar->bv, _fvmVar->bw};
+    const std::array<Vec, 3> x{_fvmVar->xu, _fvmVar->xv, _fvmVar->xw};
+    const std::array<Vec, 3> h{_fvmVar->hu, _fvmVar->hv, _fvmVar->hw};
+
+    for (int c = 0; c < 3; ++c) {
+        // H / aP = (b - A x) / aP + x
+        MatMult(_fvmVar->Am, x[c], _fvmVar->temp2);
+
+        const FieldRead bc(b[c]), xc(x[c]), ax(_fvmVar->temp2), ap(_fvmVar->ap);
+        const FieldWrite hc(h[c]);
+        for (int i = 0; i < elementsNb; ++i)
+            hc[i] = (bc[i] - ax[i]) / ap[i] + xc[i];
+    }
+
+    {
+        const FieldRead ap(_fvmVar->ap);
+        const FieldWrite rAU(_fvmVar->temp1);
+        for (int i = 0; i < elementsNb; ++i)
+            rAU[i] = elements.Vp[i] / ap[i];
+    }
+}
+
+std::vector<Vec> FvmFlowSolver::HbyAFields() const {
+    return {_fvmVar->hu, _fvmVar->hv, _fvmVar->hw, _fvmVar->temp1};
+}
+
+void FvmFlowSolver::BuildPressureMatrix() {
+    PetscLogEventBegin(FvmLog::Event("FvmPressureMatrix"), 0, 0, 0, 0);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+    const Mat Ac = _fvmVar->Ac;
+
+    // Diagonals accumulate in the first elementsNb COO entries
+    std::fill_n(_coefficients.begin(), elementsNb, 0.0);
+
+    // The ghosts of ComputeHbyA arrive while the interior faces are assembled
+    OverlappedFaceLoop(_fvmMesh->faceSplit, HbyAFields(), [&](const std::span<const int> faceList) {
+        const GhostedFieldRead dens(_fvmVar->dens), rAU(_fvmVar->temp1);
+
+        for (const int i: faceList) {
+            const int owner = faces.owner[i];
+            const int neighbour = Neighbour(faces, i);
+
+            if (neighbour != -1) {
+                const double lambda = coefficients.lambda[i];
+                const double a = Interpolate(dens, owner, neighbour, lambda) *
+                                 Interpolate(rAU, owner, neighbour, lambda) * coefficients.diffusion[i];
+
+                _coefficients[owner] += a;
+                _coefficients[_sparsity.OwnerEntry(i)] = -a;
+
+                if (neighbour < elementsNb) {
+                    _coefficients[neighbour] += a;
+                    _coefficients[_sparsity.NeighbourEntry(i)] = -a;
+                }
+            } else if (GetBoundaryKind(faces.bc[i]) == BoundaryKind::PRESSURE) {
+                _coefficients[owner] += dens[owner] * rAU[owner] * coefficients.diffusion[i];
+            }
+        }
+    });
+
+    _sparsity.SetValues(Ac, _coefficients);
+    _sparsity.CheckAssembly(Ac, "Pressure matrix");
+    _pressureSolver->MatrixUpdated();
+
+    PetscLogEventEnd(FvmLog::Event("FvmPressureMatrix"), 0, 0, 0, 0);
+}
+
+double FvmFlowSolver::NonOrthogonalCorrection(const int face, const int neighbour, const Gradient &gradP) const {
+    // Pressure difference between rnl and rpl minus the one between the centres
+    const FvmFaceCoefficients &s = _fvmMesh->faceCoefficients;
+    const int owner = _fvmMesh->storage.owner[face];
+
+    const double correction =
+            gradP.x[neighbour] * s.px[face] + gradP.y[neighbour] * s.py[face] + gradP.z[neighbour] * s.pz[face] -
+            gradP.x[owner] * s.ox[face] - gradP.y[owner] * s.oy[face] - gradP.z[owner] * s.oz[face];
+
+    return fvmParameter.orthof * correction;
+}
+
+void FvmFlowSolver::BuildPressureSource(const bool nonOrthogonalCorrection, const bool refresh) {
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+
+    {
+        const FieldWrite bp(_fvmVar->bp);
+        for (int i = 0; i < elementsNb; ++i)
+            bp[i] = 0.0;
+    }
+
+    // sum_f a (pP - pN) = -sum_f dens (H/aP)_f . S_f
+    const std::vector<Vec> stale = refresh ? HbyAFields() : std::vector<Vec>();
+    OverlappedFaceLoop(_fvmMesh->faceSplit, stale, [&](const std::span<const int> faceList) {
+        const GhostedFieldRead dens(_fvmVar->dens), rAU(_fvmVar->temp1);
+        const GhostedFieldRead hu(_fvmVar->hu), hv(_fvmVar->hv), hw(_fvmVar->hw);
+        const GhostedFieldRead xuf(_fvmVar->xuf), xvf(_fvmVar->xvf), xwf(_fvmVar->xwf), xpf(_fvmVar->xpf);
+        const Gradient gradP{GhostedFieldRead(_gradP[0]), GhostedFieldRead(_gradP[1]), GhostedFieldRead(_gradP[2])};
+        const FieldWrite bp(_fvmVar->bp);
+
+        for (const int i: faceList) {
+            const int owner = faces.owner[i];
+            const int neighbour = Neighbour(faces, i);
+            const double s = coefficients.orientation[i];
+            const double nx = s * faces.nx[i], ny = s * faces.ny[i], nz = s * faces.nz[i];
+
+            if (neighbour != -1) {
+                const double lambda = coefficients.lambda[i];
+                const double densf = Interpolate(dens, owner, neighbour, lambda);
+                double flux = densf * (Interpolate(hu, owner, neighbour, lambda) * nx +
+                                       Interpolate(hv, owner, neighbour, lambda) * ny +
+                                       Interpolate(hw, owner, neighbour, lambda) * nz) * faces.Aj[i];
+
+                if (nonOrthogonalCorrection)
+                    flux -= densf * Interpolate(rAU, owner, neighbour, lambda) * coefficients.diffusion[i] *
+                            NonOrthogonalCorrection(i, neighbour, gradP);
+
+                bp[owner] -= flux;
+                if (neighbour < elementsNb)
+                    bp[neighbour] += flux;
+                continue;
+            }
+
+            switch (GetBoundaryKind(faces.bc[i])) {
+                case BoundaryKind::VELOCITY:
+                    bp[owner] -= dens[owner] * (xuf[i] * nx + xvf[i] * ny + xwf[i] * nz) * faces.Aj[i];
+                    break;
+                case BoundaryKind::PRESSURE: {
+                    const double a = dens[owner] * rAU[owner] * coefficients.diffusion[i];
+                    bp[owner] += a * xpf[i] - dens[owner] * (hu[owner] * nx + hv[owner] * ny + hw[owner] * nz) *
+                            faces.Aj[i];
+                    break;
+                }
+                case BoundaryKind::NO_FLUX:
+                    break;
+            }
+        }
+    });
+}
+
+double FvmFlowSolver::SolvePressure(int &iterations) {
+    PetscLogEventBegin(FvmLog::Event("FvmPressureSolve"), 0, 0, 0, 0);
+
+    const double residual = _pressureSolver->Solve(_fvmVar->bp, _fvmVar->xp, iterations);
+
+    PetscLogEventEnd(FvmLog::Event("FvmPressureSolve"), 0, 0, 0, 0);
+
+    return residual;
+}
+
+void FvmFlowSolver::CorrectFlux(const bool nonOrthogonalCorrection) {
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+
+    // uf along the outward normal of the owner, from the pressure just solved; its ghosts
+    // arrive while the interior faces are computed
+    OverlappedFaceLoop(_fvmMesh->faceSplit, {_fvmVar->xp}, [&](const std::span<const int> faceList) {
+        const GhostedFieldRead rAU(_fvmVar->temp1), xp(_fvmVar->xp);
+        const GhostedFieldRead hu(_fvmVar->hu), hv(_fvmVar->hv), hw(_fvmVar->hw);
+        const GhostedFieldRead xuf(_fvmVar->xuf), xvf(_fvmVar->xvf), xwf(_fvmVar->xwf), xpf(_fvmVar->xpf);
+        const Gradient gradP{GhostedFieldRead(_gradP[0]), GhostedFieldRead(_gradP[1]), GhostedFieldRead(_gradP[2])};
+        const GhostedFieldWrite uf(_fvmVar->uf);
+
+        for (const int i: faceList) {
+            const int owner = faces.owner[i];
+            const int neighbour = Neighbour(faces, i);
+            const double s = coefficients.orientation[i];
+            const double nx = s * faces.nx[i], ny = s * faces.ny[i], nz = s * faces.nz[i];
+
+            if (neighbour != -1) {
+                const double lambda = coefficients.lambda[i];
+                uf[i] = Interpolate(hu, owner, neighbour, lambda) * nx +
+                        Interpolate(hv, owner, neighbour, lambda) * ny +
+                        Interpolate(hw, owner, neighbour, lambda) * nz -
+                        Interpolate(rAU, owner, neighbour, lambda) * (xp[neighbour] - xp[owner]) *
+                        coefficients.inverseDistance[i];
+
+                if (nonOrthogonalCorrection)
+                    uf[i] -= Interpolate(rAU, owner, neighbour, lambda) *
+                            NonOrthogonalCorrection(i, neighbour, gradP) * coefficients.inverseDistance[i];
+                continue;
+            }
+
+            switch (GetBoundaryKind(faces.bc[i])) {
+                case BoundaryKind::VELOCITY:
+                    uf[i] = xuf[i] * nx + xvf[i] * ny + xwf[i] * nz;
+                    break;
+                case BoundaryKind::PRESSURE:
+                    uf[i] = hu[owner] * nx + hv[owner] * ny + hw[owner] * nz -
+                            rAU[owner] * (xpf[i] - xp[owner]) * coefficients.inverseDistance[i];
+                    break;
+                case BoundaryKind::NO_FLUX:
+                    uf[i] = 0.0;
+                    break;
+            }
+        }
+    });
+}
+
+void FvmFlowSolver::CorrectVelocity() {
+    ComputePressureGradient();
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const std::array<Vec, 3> x{_fvmVar->xu, _fvmVar->xv, _fvmVar->xw};
+    const std::array<Vec, 3> h{_fvmVar->hu, _fvmVar->hv, _fvmVar->hw};
+    for (const int c: {U, V, W}) {
+        if (!fvmParameter.calc[c])
+            continue;
+
+        // u = H / aP - V / aP grad(p)
+        const FieldRead hc(h[c]), rAU(_fvmVar->temp1), gradP(_gradP[c]);
+        const FieldWrite xc(x[c]);
+        for (int i = 0; i < elementsNb; ++i)
+            xc[i] = hc[i] - rAU[i] * gradP[i];
+    }
+
+    FvmVector::V_GhostUpdate({_fvmVar->xu, _fvmVar->xv, _fvmVar->xw});
+}
+
+void FvmFlowSolver::ComputePressureGradient(const bool refresh) {
+    // Limiting the pressure gradient would break the Rhie-Chow balance
+    _gradient.Compute({{_fvmVar->xp, _fvmVar->xpf, FixesPressure, _gradP, refresh}},
+                      static_cast<FvmGradientMethod>(fvmParameter.gradient), FvmGradientLimiter::NONE);
+}
@@ -0,0 +1,104 @@
+#ifndef FVMFLOWSOLVER_HPP
+#define FVMFLOWSOLVER_HPP
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Globals.hpp"
+#include "FvmSparsity.hpp"
+#include "FvmLinearSolver.hpp"
+#include "FvmGradient.hpp"
+#include "FvmMomentum.hpp"
+#include "FvmFlowFaces.hpp"
+
+#include "petscksp.h"
+
+class FvmMeshContainer;
+class FvmVar;
+
+/**
+ * Pressure-velocity coupling of the incompressible flow equations on the
+ * collocated cell layout of FvmVar. A steady run does one SIMPLE iteration
+ * per call, under-relaxed with fvmParameter.ef; a transient run does one
+ * PISO step with fvmParameter.npisocor pressure correctors. Face fluxes
+ * follow Rhie-Chow: uf = (H/aP)_f . n - (V/aP)_f (pN - pP) / dj.
+ *
+ * The momentum (Am) and pressure (Ac) matrices register their COO pattern
+ * once (FvmSparsity) and every assembly pushes one coefficient array. Both
+ * linear solvers (FvmLinearSolver, prefixes vel_ and p_) live as long as the
+ * solver, so time steps do not allocate; u, v and w share the vel_ solver.
+ */
+class FvmFlowSolver {
+public:
+    FvmFlowSolver(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar);
+
+    ~FvmFlowSolver();
+
+    FvmFlowSolver(const FvmFlowSolver &) = delete;
+
+    FvmFlowSolver &operator=(const FvmFlowSolver &) = delete;
+
+    //! Advances the flow by one iteration (steady) or one time step dt.
+    //! fres/fiter receive the normalised residuals and linear iterations.
+    void Iterate(double dt, std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter);
+
+    //! Cell pattern and gradients, shared with the transport equations
+    [[nodiscard]] const FvmSparsity &Sparsity() const { return _sparsity; }
+
+    [[nodiscard]] const FvmGradient &GradientOperator() const { return _gradient; }
+
+private:
+    //! FvmMomentum coefficients into Am
+    void BuildMomentumMatrix(double dt);
+
+    void SolveMomentum(std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter);
+
+    //! hu/hv/hw = H / aP of the current velocity, temp1 = V / aP; their ghosts are
+    //! updated by the next pressure face loop, overlapped with its interior faces
+    void ComputeHbyA();
+
+    //! hu, hv, hw and temp1, ghost-updated together
+    [[nodiscard]] std::vector<Vec> HbyAFields() const;
+
+    //! Updates the ghosts left by ComputeHbyA
+    void BuildPressureMatrix();
+
+    //! refresh: update the ghosts left by ComputeHbyA (no pressure matrix since)
+    void BuildPressureSource(bool nonOrthogonalCorrection, bool refresh);
+
+    //! Solves Ac xp = bp; returns the residual before the solve
+    double SolvePressure(int &iterations);
+
+    //! Conservative face flux from the new pressure; updates the ghosts of xp
+    void CorrectFlux(bool nonOrthogonalCorrection);
+
+    //! Explicit pressure difference of a face with a neighbour (pair or ghost) from the gradient gradP
+    [[nodiscard]] double NonOrthogonalCorrection(int face, int neighbour, const FvmFlow::Gradient &gradP) const;
+
+    void CorrectVelocity();
+
+    //! Gradient of xp into _gradP; the ghost values of xp must be current unless refresh
+    void ComputePressureGradient(bool refresh = false);
+
+private:
+    std::shared_ptr<FvmMeshContainer> _fvmMesh;
+    std::shared_ptr<FvmVar> _fvmVar;
+
+    FvmSparsity _sparsity;
+    FvmGradient _gradient;
+    FvmMomentum _momentum;
+
+    std::unique_ptr<FvmLinearSolver> _momentumSolver;
+    std::unique_ptr<FvmLinearSolver> _pressureSolver;
+
+    bool _steady = false;
+    bool _pressureFixed = false; //! Some boundary fixes the pressure level
+    bool _nonOrthogonal = false; //! Some interior face needs the non-orthogonal correction
+
+    std::vector<PetscScalar> _coefficients; //! COO values of the matrix being assembled
+    std::array<Vec, 3> _gradP{}; //! Pressure gradient, ghosted like xp
+};
+
+#endif
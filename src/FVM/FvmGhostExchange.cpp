@@ -0,0 +1,85 @@
+#include "FvmGhostExchange.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmLog.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <set>
+
+FvmGhostExchange::FvmGhostExchange(const int localSize, const std::vector<int> &ghosts, const int fieldsNb)
+    : _localSize(localSize),
+      _ghostsNb(static_cast<int>(ghosts.size())),
+      _fieldsNb(fieldsNb) {
+    VecCreateGhostBlock(PETSC_COMM_WORLD, fieldsNb, localSize * fieldsNb, PETSC_DECIDE,
+                        _ghostsNb, ghosts.data(), &_packed);
+
+    // Ghost owners: one incoming message per neighbour rank
+    const PetscInt *ranges;
+    VecGetOwnershipRanges(_packed, &ranges);
+
+    int size;
+    MPI_Comm_size(PETSC_COMM_WORLD, &size);
+
+    std::set<int> owners;
+    for (const int ghost: ghosts) {
+        const auto it = std::upper_bound(ranges, ranges + size + 1, static_cast<PetscInt>(ghost) * fieldsNb);
+        owners.insert(static_cast<int>(it - ranges) - 1);
+    }
+
+    _statistics.messages = static_cast<int>(owners.size());
+    _statistics.bytes = static_cast<std::size_t>(_ghostsNb) * fieldsNb * sizeof(PetscScalar);
+}
+
+FvmGhostExchange::~FvmGhostExchange() {
+    if (_packed)
+        VecDestroy(&_packed);
+}
+
+void FvmGhostExchange::Begin(const std::vector<Vec> &fields) {
+    if (static_cast<int>(fields.size()) > _fieldsNb)
+        throw FvmException("Too many fields for ghost exchange", LOGICAL_ERROR);
+    if (_inFlight)
+        throw FvmException("Ghost exchange begun twice without End", LOGICAL_ERROR);
+
+    PetscLogEventBegin(FvmLog::Event("FvmGhostExchange"), 0, 0, 0, 0);
+
+    {
+        const FieldWrite packed(_packed);
+        for (std::size_t f = 0; f < fields.size(); ++f) {
+            const FieldRead field(fields[f]);
+            for (int i = 0; i < _localSize; ++i)
+                packed[i * _fieldsNb + f] = field[i];
+        }
+    }
+
+    VecGhostUpdateBegin(_packed, INSERT_VALUES, SCATTER_FORWARD);
+    _inFlight = true;
+}
+
+void FvmGhostExchange::End(const std::vector<Vec> &fields) {
+    if (!_inFlight)
+        throw FvmException("Ghost exchange ended without Begin", LOGICAL_ERROR);
+
+    VecGhostUpdateEnd(_packed, INSERT_VALUES, SCATTER_FORWARD);
+    _inFlight = false;
+
+    {
+        const GhostedFieldRead packed(_packed);
+        for (std::size_t f = 0; f < fields.size(); ++f) {
+            const GhostedFieldWrite field(fields[f]);
+            for (int g = _localSize; g < _localSize + _ghostsNb; ++g)
+                field[g] = packed[g * _fieldsNb + f];
+        }
+    }
+
+    ++_statistics.exchanges;
+
+    PetscLogEventEnd(FvmLog::Event("FvmGhostExchange"), 0, 0, 0, 0);
+
+    if (verbose) {
+        PetscSynchronizedPrintf(PETSC_COMM_WORLD, "[%d] Ghost exchange of %d fields: %d messages, %zu bytes\n",
+                                processor, static_cast<int>(fields.size()),
+                                _statistics.messages, _statistics.bytes);
+        PetscSynchronizedFlush(PETSC_COMM_WORLD, PETSC_STDOUT);
+    }
+}
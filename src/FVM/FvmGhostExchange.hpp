@@ -0,0 +1,56 @@
+#ifndef FVMGHOSTEXCHANGE_HPP
+#define FVMGHOSTEXCHANGE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "petscvec.h"
+
+/**
+ * Ghost update of several cell fields in one scatter. The owned values of
+ * up to fieldsNb ghosted vectors (same layout as FvmVector::V_Constr) are
+ * interleaved into a block vector created with VecCreateGhostBlock, so
+ * every neighbour rank receives a single message per exchange instead of
+ * one per field. Begin/End may be split to overlap the exchange with work
+ * that does not read ghost values; one exchange has at most one scatter
+ * in flight.
+ */
+class FvmGhostExchange {
+public:
+    struct Statistics {
+        int exchanges = 0;
+        int messages = 0; //! Messages received per exchange (neighbour ranks)
+        std::size_t bytes = 0; //! Bytes received per exchange
+    };
+
+    FvmGhostExchange(int localSize, const std::vector<int> &ghosts, int fieldsNb);
+
+    ~FvmGhostExchange();
+
+    FvmGhostExchange(const FvmGhostExchange &) = delete;
+
+    FvmGhostExchange &operator=(const FvmGhostExchange &) = delete;
+
+    //! Packs the owned values of fields and starts the scatter
+    void Begin(const std::vector<Vec> &fields);
+
+    //! Completes the scatter and copies the ghost values back into fields
+    void End(const std::vector<Vec> &fields);
+
+    [[nodiscard]] int FieldsNumber() const { return _fieldsNb; }
+
+    [[nodiscard]] bool InFlight() const { return _inFlight; }
+
+    [[nodiscard]] const Statistics &GetStatistics() const { return _statistics; }
+
+private:
+    int _localSize;
+    int _ghostsNb;
+    int _fieldsNb;
+
+    Vec _packed = nullptr;
+    bool _inFlight = false; //! Between Begin and End
+    Statistics _statistics;
+};
+
+#endif
@@ -0,0 +1,293 @@
+#include "FvmGradient.hpp"
+#include "FvmVar.hpp"
+#include "FvmVector.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmFlowFaces.hpp"
+#include "FvmFaceLoop.hpp"
+#include "FvmLog.hpp"
+#include "FvmParam.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FvmFlow;
+
+FvmGradient::FvmGradient(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar)
+    : _fvmMesh(fvmMesh),
+      _elementsNb(fvmMesh->elementsNb),
+      _facesNb(fvmMesh->storage.Faces().size) {
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto elements = _fvmMesh->storage.Elements();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+
+    _owner.resize(_facesNb);
+    _neighbour.resize(_facesNb);
+    for (auto *v: {&_sx, &_sy, &_sz, &_dx, &_dy, &_dz, &_rx, &_ry, &_rz})
+        v->resize(_facesNb);
+
+    _inverseVolume.resize(_elementsNb);
+    _leastSquares.assign(6 * _elementsNb, 0.0);
+    _epsilon2.resize(_elementsNb);
+
+    const Centres centres{
+        GhostedFieldRead(fvmVar->cex), GhostedFieldRead(fvmVar->cey), GhostedFieldRead(fvmVar->cez)
+    };
+
+    // Least-squares matrices, inverted below
+    std::vector<double> matrices(6 * _elementsNb, 0.0);
+    const auto accumulate = [&matrices](const int cell, const double dx, const double dy, const double dz) {
+        const double w = 1.0 / LMAX(dx * dx + dy * dy + dz * dz, VSMALL);
+        double *m = &matrices[6 * cell];
+        m[0] += w * dx * dx;
+        m[1] += w * dx * dy;
+        m[2] += w * dx * dz;
+        m[3] += w * dy * dy;
+        m[4] += w * dy * dz;
+        m[5] += w * dz * dz;
+    };
+
+    for (int i = 0; i < _facesNb; ++i) {
+        const int owner = faces.owner[i];
+        const int neighbour = Neighbour(faces, i);
+        const double s = coefficients.orientation[i] * faces.Aj[i];
+
+        _owner[i] = owner;
+        _neighbour[i] = neighbour;
+        _sx[i] = s * faces.nx[i];
+        _sy[i] = s * faces.ny[i];
+        _sz[i] = s * faces.nz[i];
+        _rx[i] = faces.cx[i] - centres.x[owner];
+        _ry[i] = faces.cy[i] - centres.y[owner];
+        _rz[i] = faces.cz[i] - centres.z[owner];
+
+        if (neighbour != -1) {
+            _dx[i] = centres.x[neighbour] - centres.x[owner];
+            _dy[i] = centres.y[neighbour] - centres.y[owner];
+            _dz[i] = centres.z[neighbour] - centres.z[owner];
+        } else {
+            _dx[i] = _rx[i];
+            _dy[i] = _ry[i];
+            _dz[i] = _rz[i];
+        }
+
+        accumulate(owner, _dx[i], _dy[i], _dz[i]);
+        if (faces.pair[i] != -1)
+            accumulate(neighbour, -_dx[i], -_dy[i], -_dz[i]);
+    }
+
+    for (int i = 0; i < _elementsNb; ++i) {
+        _inverseVolume[i] = 1.0 / elements.Vp[i];
+        _epsilon2[i] = std::pow(venkatakrishnanK * std::cbrt(elements.Vp[i]), 3);
+
+        // Symmetric 3x3 inverse by cofactors; the regularisation keeps flat
+        // (2D) cells invertible, their gradient normal to the plane is 0
+        const double *m = &matrices[6 * i];
+        const double eps = 1e-12 * (m[0] + m[3] + m[5]);
+        const double xx = m[0] + eps, xy = m[1], xz = m[2], yy = m[3] + eps, yz = m[4], zz = m[5] + eps;
+
+        const double cxx = yy * zz - yz * yz;
+        const double cxy = xz * yz - xy * zz;
+        const double cxz = xy * yz - xz * yy;
+        const double det = xx * cxx + xy * cxy + xz * cxz;
+        if (LABS(det) < VSMALL)
+            continue;
+
+        double *inverse = &_leastSquares[6 * i];
+        inverse[0] = cxx / det;
+        inverse[1] = cxy / det;
+        inverse[2] = cxz / det;
+        inverse[3] = (xx * zz - xz * xz) / det;
+        inverse[4] = (xy * xz - xx * yz) / det;
+        inverse[5] = (xx * yy - xy * xy) / det;
+    }
+}
+
+void FvmGradient::Compute(const std::vector<FvmGradientField> &fields) const {
+    Compute(fields, static_cast<FvmGradientMethod>(fvmParameter.gradient),
+            static_cast<FvmGradientLimiter>(fvmParameter.limiter));
+}
+
+void FvmGradient::Compute(const std::vector<FvmGradientField> &fields, const FvmGradientMethod method,
+                          const FvmGradientLimiter limiter) const {
+    PetscLogEventBegin(FvmLog::Event("FvmGradient"), 0, 0, 0, 0);
+
+    const int fieldsNb = static_cast<int>(fields.size());
+    const bool leastSquares = method == FvmGradientMethod::LEAST_SQUARES;
+
+    {
+        std::vector<std::unique_ptr<FieldWrite> > outputs;
+        std::vector<double *> gradients; //! x, y, z of every field
+        std::vector<Vec> stale;
+        for (const auto &field: fields) {
+            for (const Vec g: field.gradient) {
+                outputs.push_back(std::make_unique<FieldWrite>(g));
+                gradients.push_back(outputs.back()->Data());
+                std::fill_n(gradients.back(), _elementsNb, 0.0);
+            }
+            if (field.refresh)
+                stale.push_back(field.cell);
+        }
+
+        const auto openInputs = [&fields](std::vector<std::unique_ptr<GhostedFieldRead> > &cells,
+                                          std::vector<std::unique_ptr<GhostedFieldRead> > &boundaries) {
+            for (const auto &field: fields) {
+                cells.push_back(std::make_unique<GhostedFieldRead>(field.cell));
+                boundaries.push_back(field.face ? std::make_unique<GhostedFieldRead>(field.face) : nullptr);
+            }
+        };
+
+        const double *weight = _fvmMesh->faceCoefficients.lambda.data();
+        const BndCondType *bc = _fvmMesh->storage.bc.data();
+        OverlappedFaceLoop(_fvmMesh->faceSplit, stale, [&](const std::span<const int> faceList) {
+            std::vector<std::unique_ptr<GhostedFieldRead> > cells, boundaries;
+            openInputs(cells, boundaries);
+
+            for (const int i: faceList) {
+                const int owner = _owner[i];
+                const int neighbour = _neighbour[i];
+                const bool interior = neighbour != -1 && neighbour < _elementsNb && bc[i] != BndCondType::PROCESSOR;
+
+                for (int k = 0; k < fieldsNb; ++k) {
+                    const GhostedFieldRead &phi = *cells[k];
+                    double *gx = gradients[3 * k], *gy = gradients[3 * k + 1], *gz = gradients[3 * k + 2];
+
+                    double value;
+                    if (neighbour != -1) {
+                        value = leastSquares ? phi[neighbour] : Interpolate(phi, owner, neighbour, weight[i]);
+                    } else {
+                        const bool fixed = boundaries[k] && (!fields[k].fixed || fields[k].fixed(bc[i]));
+                        value = fixed ? (*boundaries[k])[i] : phi[owner];
+                    }
+
+                    if (leastSquares) {
+                        // The offset and the difference both flip for the pair
+                        const double difference = value - phi[owner];
+                        const double w = difference /
+                                         LMAX(_dx[i] * _dx[i] + _dy[i] * _dy[i] + _dz[i] * _dz[i], VSMALL);
+                        gx[owner] += w * _dx[i];
+                        gy[owner] += w * _dy[i];
+                        gz[owner] += w * _dz[i];
+                        if (interior) {
+                            gx[neighbour] += w * _dx[i];
+                            gy[neighbour] += w * _dy[i];
+                            gz[neighbour] += w * _dz[i];
+                        }
+                    } else {
+                        gx[owner] += value * _sx[i];
+                        gy[owner] += value * _sy[i];
+                        gz[owner] += value * _sz[i];
+                        if (interior) {
+                            gx[neighbour] -= value * _sx[i];
+                            gy[neighbour] -= value * _sy[i];
+                            gz[neighbour] -= value * _sz[i];
+                        }
+                    }
+                }
+            }
+        });
+
+        for (int k = 0; k < fieldsNb; ++k) {
+            double *gx = gradients[3 * k], *gy = gradients[3 * k + 1], *gz = gradients[3 * k + 2];
+            for (int i = 0; i < _elementsNb; ++i) {
+                if (leastSquares) {
+                    const double *m = &_leastSquares[6 * i];
+                    const double bx = gx[i], by = gy[i], bz = gz[i];
+                    gx[i] = m[0] * bx + m[1] * by + m[2] * bz;
+                    gy[i] = m[1] * bx + m[3] * by + m[4] * bz;
+                    gz[i] = m[2] * bx + m[4] * by + m[5] * bz;
+                } else {
+                    gx[i] *= _inverseVolume[i];
+                    gy[i] *= _inverseVolume[i];
+                    gz[i] *= _inverseVolume[i];
+                }
+            }
+        }
+
+        if (limiter != FvmGradientLimiter::NONE) {
+            std::vector<std::unique_ptr<GhostedFieldRead> > cells, boundaries;
+            openInputs(cells, boundaries);
+            Limit(cells, limiter, gradients);
+        }
+    }
+
+    std::vector<Vec> ghosted;
+    for (const auto &field: fields)
+        ghosted.insert(ghosted.end(), field.gradient.begin(), field.gradient.end());
+    FvmVector::V_GhostUpdate(ghosted);
+
+    PetscLogEventEnd(FvmLog::Event("FvmGradient"), 0, 0, 0, 0);
+}
+
+void FvmGradient::Limit(const std::vector<std::unique_ptr<GhostedFieldRead> > &cells,
+                        const FvmGradientLimiter limiter, const std::vector<double *> &gradients) const {
+    const BndCondType *bc = _fvmMesh->storage.bc.data();
+    const int fieldsNb = static_cast<int>(cells.size());
+
+    // Factor limiting the face extrapolation delta to the range dmax / dmin
+    const auto factor = [limiter](const double delta, const double dmax, const double dmin, const double eps2) {
+        if (LABS(delta) < VSMALL)
+            return 1.0;
+
+        const double bound = delta > 0.0 ? dmax : dmin;
+        if (limiter == FvmGradientLimiter::BARTH_JESPERSEN)
+            return LMIN(1.0, bound / delta);
+
+        const double b2 = bound * bound, d2 = delta * delta;
+        return (b2 + eps2 + 2.0 * delta * bound) / (b2 + 2.0 * d2 + delta * bound + eps2);
+    };
+
+    std::vector<double> minimum(fieldsNb * _elementsNb), maximum(fieldsNb * _elementsNb);
+    std::vector<double> psi(fieldsNb * _elementsNb, 1.0);
+
+    for (int k = 0; k < fieldsNb; ++k) {
+        const GhostedFieldRead &phi = *cells[k];
+        double *lo = &minimum[k * _elementsNb], *hi = &maximum[k * _elementsNb];
+
+        for (int i = 0; i < _elementsNb; ++i)
+            lo[i] = hi[i] = phi[i];
+
+        // Neighbour range; boundary cells only see their own value
+        for (int i = 0; i < _facesNb; ++i) {
+            const int owner = _owner[i], neighbour = _neighbour[i];
+            if (neighbour == -1)
+                continue;
+
+            lo[owner] = LMIN(lo[owner], phi[neighbour]);
+            hi[owner] = LMAX(hi[owner], phi[neighbour]);
+            if (neighbour < _elementsNb && bc[i] != BndCondType::PROCESSOR) {
+                lo[neighbour] = LMIN(lo[neighbour], phi[owner]);
+                hi[neighbour] = LMAX(hi[neighbour], phi[owner]);
+            }
+        }
+
+        const double *gx = gradients[3 * k], *gy = gradients[3 * k + 1], *gz = gradients[3 * k + 2];
+        double *limit = &psi[k * _elementsNb];
+
+        for (int i = 0; i < _facesNb; ++i) {
+            const int owner = _owner[i], neighbour = _neighbour[i];
+            const double rx = _rx[i], ry = _ry[i], rz = _rz[i];
+
+            const double deltaOwner = gx[owner] * rx + gy[owner] * ry + gz[owner] * rz;
+            limit[owner] = LMIN(limit[owner], factor(deltaOwner, hi[owner] - phi[owner], lo[owner] - phi[owner],
+                                                     _epsilon2[owner]));
+
+            if (neighbour != -1 && neighbour < _elementsNb && bc[i] != BndCondType::PROCESSOR) {
+                // Face centre seen from the neighbour
+                const double nx = rx - _dx[i], ny = ry - _dy[i], nz = rz - _dz[i];
+                const double deltaNeighbour = gx[neighbour] * nx + gy[neighbour] * ny + gz[neighbour] * nz;
+                limit[neighbour] = LMIN(limit[neighbour],
+                                        factor(deltaNeighbour, hi[neighbour] - phi[neighbour],
+                                               lo[neighbour] - phi[neighbour], _epsilon2[neighbour]));
+            }
+        }
+    }
+
+    for (int k = 0; k < fieldsNb; ++k) {
+        const double *limit = &psi[k * _elementsNb];
+        for (int c = 0; c < 3; ++c) {
+            double *g = gradients[3 * k + c];
+            for (int i = 0; i < _elementsNb; ++i)
+                g[i] *= limit[i];
+        }
+    }
+}
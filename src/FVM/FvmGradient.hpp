@@ -0,0 +1,88 @@
+#ifndef FVMGRADIENT_HPP
+#define FVMGRADIENT_HPP
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "FvmMesh.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmConvection.hpp"
+
+#include "petscvec.h"
+
+class FvmVar;
+
+enum class FvmGradientMethod {
+    GREEN_GAUSS = 0, //! Linear face interpolation, sum_f phi_f S_f / Vp
+    LEAST_SQUARES = 1 //! Inverse-distance weighted fit to the neighbour values
+};
+
+enum class FvmGradientLimiter {
+    NONE = 0,
+    BARTH_JESPERSEN = 1,
+    VENKATAKRISHNAN = 2
+};
+
+//! One field handed to FvmGradient::Compute
+struct FvmGradientField {
+    Vec cell = nullptr; //! Ghosted cell values (ghosts must be current unless refresh)
+    Vec face = nullptr; //! Boundary face values, or nullptr for zero gradient
+    bool (*fixed)(BndCondType) = nullptr; //! Boundaries taking the face value (all when null)
+    std::array<Vec, 3> gradient{}; //! Ghosted output; ghosts are updated
+    bool refresh = false; //! Ghosts of cell are updated by Compute, overlapped with the interior faces
+};
+
+/**
+ * Cell gradient operators with their geometry precomputed once: per face
+ * the outward area vector of the owner and the centre offsets; per cell
+ * 1 / Vp and the symmetric inverse of the least-squares matrix
+ * sum_f w d d^T (w = 1 / |d|^2, six entries). Interpolation weights are
+ * the face coefficients of FvmMeshStorage.
+ *
+ * Compute() runs over the faces once for all the given fields, so several
+ * fields share one sweep through the geometry, then limits and
+ * ghost-updates all gradients together. The ghost update of the refresh
+ * fields runs during the sweep over the interior faces (OverlappedFaceLoop).
+ */
+class FvmGradient {
+public:
+    FvmGradient(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar);
+
+    //! Method and limiter of fvmParameter.gradient and fvmParameter.limiter
+    void Compute(const std::vector<FvmGradientField> &fields) const;
+
+    void Compute(const std::vector<FvmGradientField> &fields, FvmGradientMethod method,
+                 FvmGradientLimiter limiter) const;
+
+    //! Face arrays for the convection kernels
+    [[nodiscard]] FvmConvection::Stencil Stencil() const {
+        return {_facesNb, _elementsNb, _owner.data(), _neighbour.data(), _fvmMesh->faceCoefficients.lambda.data(),
+                _dx.data(), _dy.data(), _dz.data()};
+    }
+
+private:
+    void Limit(const std::vector<std::unique_ptr<GhostedFieldRead> > &cells, FvmGradientLimiter limiter,
+               const std::vector<double *> &gradients) const;
+
+private:
+    static constexpr double venkatakrishnanK = 5.0;
+
+    std::shared_ptr<FvmMeshContainer> _fvmMesh;
+
+    int _elementsNb = 0;
+    int _facesNb = 0;
+
+    // Per face
+    std::vector<int> _owner, _neighbour; //! Neighbour: pair, ghost slot or -1
+    std::vector<double> _sx, _sy, _sz; //! Area vector, outward from the owner
+    std::vector<double> _dx, _dy, _dz; //! Neighbour (boundary: face) centre minus owner centre
+    std::vector<double> _rx, _ry, _rz; //! Face centre minus owner centre
+
+    // Per cell
+    std::vector<double> _inverseVolume;
+    std::vector<double> _leastSquares; //! xx, xy, xz, yy, yz, zz of the inverse matrix
+    std::vector<double> _epsilon2; //! Venkatakrishnan (K h)^3
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "FvmLinearSolver.hpp"
+#include "FvmParam.hpp"
+#include "parallel.hpp"
+
+#include <array>
+#include <string>
+
+namespace {
+    //! u, v and w are solved with one KSP over the shared momentum matrix, hence one prefix
+    constexpr std::array<const char *, nPhi> prefixes{"vel_", "vel_", "vel_", "p_", "T_", "s_"};
+
+    //! fvmParameter.msolver codes
+    constexpr std::array<KSPType, 9> solvers{
+        KSPRICHARDSON, KSPCHEBYSHEV, KSPCG, KSPGMRES, KSPFGMRES, KSPBCGS, KSPCGS, KSPTFQMR, KSPMINRES
+    };
+
+    //! fvmParameter.mprecond codes
+    constexpr std::array<PCType, 11> preconditioners{
+        PCNONE, PCJACOBI, PCSOR, PCILU, PCBJACOBI, PCASM, PCICC, PCGAMG, PCHYPRE, PCLU, PCMG
+    };
+
+    constexpr int agglomerationCode = 10;
+}
+
+FvmLinearSolver::FvmLinearSolver(const FieldIndex field, const Mat matrix, const FvmMeshContainer *mesh)
+    : _field(field),
+      _matrix(matrix) {
+    KSPCreate(PETSC_COMM_WORLD, &_ksp);
+    KSPSetOptionsPrefix(_ksp, prefixes[ToInt(field)]);
+    KSPSetOperators(_ksp, matrix, matrix);
+    _agglomeration = Configure(_ksp, field, mesh);
+    KSPSetFromOptions(_ksp);
+}
+
+FvmLinearSolver::~FvmLinearSolver() {
+    if (_ksp)
+        KSPDestroy(&_ksp);
+    if (_residual)
+        VecDestroy(&_residual);
+}
+
+std::unique_ptr<FvmAgglomeration> FvmLinearSolver::Configure(const KSP ksp, const FieldIndex field,
+                                                            const FvmMeshContainer *mesh) {
+    const int c = ToInt(field);
+    const int solver = fvmParameter.msolver[c];
+    const int preconditioner = fvmParameter.mprecond[c];
+
+    if (solver < 0 || solver >= static_cast<int>(solvers.size()))
+        throw FvmException("Unknown msolver code " + std::to_string(solver), LOGICAL_ERROR);
+    if (preconditioner < 0 || preconditioner >= static_cast<int>(preconditioners.size()))
+        throw FvmException("Unknown mprecond code " + std::to_string(preconditioner), LOGICAL_ERROR);
+    if (preconditioner == agglomerationCode && !mesh)
+        throw FvmException("Agglomeration multigrid needs the mesh of the equation", LOGICAL_ERROR);
+
+    KSPSetType(ksp, solvers[solver]);
+    KSPSetTolerances(ksp, fvmParameter.mtol[c], PETSC_DEFAULT, PETSC_DEFAULT, fvmParameter.miter[c]);
+    KSPSetInitialGuessNonzero(ksp, PETSC_TRUE);
+
+    // ILU and ICC factor a single rank; in parallel they run per block
+    constexpr int ilu = 3, icc = 6, blockJacobi = 4;
+    const bool factorisation = preconditioner == ilu || preconditioner == icc;
+    const PCType type = preconditioners[processorsNb > 1 && factorisation ? blockJacobi : preconditioner];
+
+    PC pc;
+    KSPGetPC(ksp, &pc);
+    PCSetType(pc, type);
+
+    std::unique_ptr<FvmAgglomeration> agglomeration;
+    if (preconditioner == agglomerationCode) {
+        agglomeration = std::make_unique<FvmAgglomeration>(*mesh);
+        agglomeration->SetupPreconditioner(pc);
+    }
+
+    if (verbose)
+        PetscPrintf(PETSC_COMM_WORLD, "Linear solver %s: %s + %s, lag %d\n", prefixes[c], solvers[solver], type,
+                    LMAX(fvmParameter.pclag, 1));
+
+    return agglomeration;
+}
+
+void FvmLinearSolver::MatrixUpdated() {
+    // Rebuilt on update 0, lag, 2 lag, ...
+    const bool reuse = _updates % LMAX(fvmParameter.pclag, 1) != 0;
+    KSPSetReusePreconditioner(_ksp, reuse ? PETSC_TRUE : PETSC_FALSE);
+    ++_updates;
+}
+
+double FvmLinearSolver::Solve(const Vec b, const Vec x, int &iterations) {
+    if (!_residual)
+        VecDuplicate(b, &_residual);
+
+    PetscReal bNorm, rNorm;
+    MatMult(_matrix, x, _residual);
+    VecAYPX(_residual, -1.0, b);
+    VecNorm(_residual, NORM_2, &rNorm);
+    VecNorm(b, NORM_2, &bNorm);
+
+    KSPSolve(_ksp, b, x);
+
+    PetscInt its;
+    KSPGetIterationNumber(_ksp, &its);
+    iterations = static_cast<int>(its);
+
+    KSPConvergedReason reason;
+    KSPGetConvergedReason(_ksp, &reason);
+    if (reason < 0)
+        PetscPrintf(PETSC_COMM_WORLD, "Warning: %s solve diverged (reason %d) after %d iterations\n",
+                    prefixes[ToInt(_field)], static_cast<int>(reason), iterations);
+
+    return bNorm > SMALL ? rNorm / bNorm : rNorm;
+}
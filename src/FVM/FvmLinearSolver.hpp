@@ -0,0 +1,59 @@
+#ifndef FVMLINEARSOLVER_HPP
+#define FVMLINEARSOLVER_HPP
+
+#include <memory>
+#include <string>
+
+#include "Globals.hpp"
+#include "FvmAgglomeration.hpp"
+
+#include "petscksp.h"
+
+/**
+ * Persistent KSP of one equation, built from the integer codes of its field
+ * in fvmParameter (msolver, mprecond, mtol, miter; see FvmParam.hpp). The
+ * KSP takes the options prefix of the field ("vel_", "p_", "T_", ...), so
+ * e.g. -p_pc_type hypre overrides the code table for pressure only. The
+ * velocity components share "vel_" (and the msolver/mprecond codes of u),
+ * as the flow solver solves them with one KSP on the same matrix.
+ *
+ * The matrix keeps its layout for the whole run, so the preconditioner
+ * setup is the only per-assembly cost left. With fvmParameter.pclag = n it
+ * is rebuilt after every n-th MatrixUpdated() and reused in between.
+ *
+ * mprecond code 10 needs the mesh: it builds an FvmAgglomeration hierarchy
+ * once and runs it as PCMG.
+ */
+class FvmLinearSolver {
+public:
+    FvmLinearSolver(FieldIndex field, Mat matrix, const FvmMeshContainer *mesh = nullptr);
+
+    ~FvmLinearSolver();
+
+    FvmLinearSolver(const FvmLinearSolver &) = delete;
+
+    FvmLinearSolver &operator=(const FvmLinearSolver &) = delete;
+
+    //! Applies msolver/mprecond/mtol/miter of field to ksp; returns the
+    //! hierarchy built for the agglomeration multigrid code, if any
+    static std::unique_ptr<FvmAgglomeration> Configure(KSP ksp, FieldIndex field, const FvmMeshContainer *mesh);
+
+    //! Marks a new assembly of the matrix; decides whether the next solve
+    //! rebuilds the preconditioner
+    void MatrixUpdated();
+
+    //! Solves A x = b; returns ||b - A x|| / ||b|| before the solve
+    double Solve(Vec b, Vec x, int &iterations);
+
+    [[nodiscard]] KSP Ksp() const { return _ksp; }
+
+private:
+    FieldIndex _field;
+    Mat _matrix = nullptr;
+    KSP _ksp = nullptr;
+    Vec _residual = nullptr; //! Scratch vector, created on the first solve
+    std::unique_ptr<FvmAgglomeration> _agglomeration;
+    int _updates = 0;
+};
+
+#endif
@@ -0,0 +1,20 @@
+#include "FvmLog.hpp"
+
+#include <map>
+
+PetscLogEvent FvmLog::Event(const std::string &name) {
+    static PetscClassId classId = 0;
+    static std::map<std::string, PetscLogEvent> events;
+
+    if (classId == 0)
+        PetscClassIdRegister("FVM", &classId);
+
+    auto it = events.find(name);
+    if (it == events.end()) {
+        PetscLogEvent event;
+        PetscLogEventRegister(name.c_str(), classId, &event);
+        it = events.emplace(name, event).first;
+    }
+
+    return it->second;
+}
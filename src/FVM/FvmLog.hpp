@@ -0,0 +1,17 @@
+#ifndef FVMLOG_HPP
+#define FVMLOG_HPP
+
+#include <string>
+
+#include "petscsys.h"
+
+/**
+ * PETSc profiling events of the FVM layer. Events are registered on first
+ * use and reported by -log_view, which is how stage timings are compared.
+ */
+class FvmLog {
+public:
+    static PetscLogEvent Event(const std::string &name);
+};
+
+#endif
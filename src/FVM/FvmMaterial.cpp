@@ -7,6 +7,21 @@
 #include "Globals.hpp"
 #include "petsc.h"
 
+double Material::Curve::operator()(const double T) const {
+    if (points.empty())
+        return 0.0;
+    if (T <= points.front().first)
+        return points.front().second;
+    if (T >= points.back().first)
+        return points.back().second;
+
+    const auto upper = std::ranges::upper_bound(points, static_cast<float>(T), {},
+                                                [](const std::pair<float, float> &p) { return p.first; });
+    const auto lower = upper - 1;
+    const double t = (T - lower->first) / (upper->first - lower->first);
+    return lower->second + t * (upper->second - lower->second);
+}
+
 MaterialsBase::MaterialsBase(const std::string &filename) {
     PetscPrintf(
         PETSC_COMM_WORLD, "\nReading material file: %s\n", filename.c_str());
@@ -36,8 +51,29 @@ MaterialsBase::MaterialsBase(const std::string &filename) {
         for (const XMLElement *prop = matElem->FirstChildElement("property"); prop;
              prop = prop->NextSiblingElement("property")) {
             std::string label = prop->Attribute("label") ? prop->Attribute("label") : "";
+
+            // <point T="...">value</point> children make a temperature table
+            Material::Curve curve;
+            for (const XMLElement *point = prop->FirstChildElement("point"); point;
+                 point = point->NextSiblingElement("point")) {
+                const char *text = point->GetText();
+                curve.points.emplace_back(point->FloatAttribute("T"), text ? std::stof(text) : 0.0f);
+            }
+            std::ranges::sort(curve.points);
+
             std::string valueStr = prop->GetText() ? prop->GetText() : "";
-            float value = std::stof(valueStr);
+            float value = curve.Empty() ? std::stof(valueStr) : curve.points.front().second;
+
+            if (!curve.Empty()) {
+                if (label == "density") mat.tables.density = curve;
+                else if (label == "viscosity") mat.tables.viscosity = curve;
+                else if (label == "specificHeat") mat.tables.specificHeat = curve;
+                else if (label == "thermalConductivity") mat.tables.thermalConductivity = curve;
+                else {
+                    std::cerr << "Property " << label << " of " << mat.label
+                            << " has no temperature table, taking its first point" << std::endl;
+                }
+            }
 
             if (label == "compressibility") mat.general.psi = value;
             else if (label == "density") mat.general.density = value;
@@ -93,6 +129,17 @@ void MaterialsBase::PrintSelf() const {
         PetscPrintf(PETSC_COMM_WORLD, "  Thermal Conductivity:\t\t%.2f\n", mat.thermal.thermalConductivity);
         PetscPrintf(PETSC_COMM_WORLD, "  Boundary Conductivity:\t%.4f\n", mat.thermal.boundaryThermalConductivity);
 
+        // Temperature tables
+        const std::pair<const char *, const Material::Curve *> curves[] = {
+            {"Density", &mat.tables.density}, {"Viscosity", &mat.tables.viscosity},
+            {"Specific Heat", &mat.tables.specificHeat}, {"Thermal Conductivity", &mat.tables.thermalConductivity}
+        };
+        for (const auto &[name, curve]: curves) {
+            if (!curve->Empty())
+                PetscPrintf(PETSC_COMM_WORLD, "  %s table:\t\t%zu points, T %.2f ... %.2f\n", name,
+                            curve->points.size(), curve->points.front().first, curve->points.back().first);
+        }
+
         // Mechanical
         PetscPrintf(PETSC_COMM_WORLD, "[Mechanical]\n");
         PetscPrintf(PETSC_COMM_WORLD, "  Poisson Ratio:\t\t\t%.4f\n", mat.mechanical.poissonRatio);
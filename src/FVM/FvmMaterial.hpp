@@ -2,9 +2,28 @@
 #define MATERIAL_HPP
 
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace Material {
+    //! Piecewise-linear property of temperature: (T, value) points by ascending T,
+    //! held constant outside the first and last point
+    struct Curve {
+        std::vector<std::pair<float, float> > points;
+
+        [[nodiscard]] bool Empty() const { return points.empty(); }
+
+        [[nodiscard]] double operator()(double T) const;
+    };
+
+    //! Temperature-dependent overrides of the constant properties (empty curves keep the constants)
+    struct Tables {
+        Curve density;
+        Curve viscosity;
+        Curve specificHeat;
+        Curve thermalConductivity;
+    };
+
     struct General {
         float psi = 0.0f;
         float density = 0.0f;
@@ -32,6 +51,7 @@ struct FvmMaterial {
     Material::General general;
     Material::Thermal thermal;
     Material::Mechanical mechanical;
+    Material::Tables tables;
 };
 
 class MaterialsBase {
@@ -0,0 +1,128 @@
+#include "FvmMaterialTable.hpp"
+#include "FvmVar.hpp"
+#include "FvmVector.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmLog.hpp"
+#include "FvmParam.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <optional>
+
+FvmMaterialTable::FvmMaterialTable(const FvmMaterial &first, const FvmMaterial &second) {
+    const std::array<const FvmMaterial *, 2> phases{&first, &second};
+
+    // Constant value and table of every property
+    const auto property = [](const FvmMaterial &m, const Property p) -> std::pair<double, const Material::Curve *> {
+        switch (p) {
+            case DENSITY:
+                return {m.general.density, &m.tables.density};
+            case VISCOSITY:
+                return {m.general.viscosity, &m.tables.viscosity};
+            case SPECIFIC_HEAT:
+                return {m.thermal.specificHeat, &m.tables.specificHeat};
+            default:
+                return {m.thermal.thermalConductivity, &m.tables.thermalConductivity};
+        }
+    };
+
+    // One grid over the temperature range of all tables
+    double Tmin = std::numeric_limits<double>::max(), Tmax = std::numeric_limits<double>::lowest();
+    for (const FvmMaterial *m: phases) {
+        for (int p = 0; p < PROPERTIES_NB; ++p) {
+            const Material::Curve *curve = property(*m, static_cast<Property>(p)).second;
+            if (curve->points.size() < 2)
+                continue;
+            Tmin = LMIN(Tmin, static_cast<double>(curve->points.front().first));
+            Tmax = LMAX(Tmax, static_cast<double>(curve->points.back().first));
+        }
+    }
+
+    if (Tmax > Tmin) {
+        _samplesNb = tableSamples;
+        _T0 = Tmin;
+        _inverseStep = (_samplesNb - 1) / (Tmax - Tmin);
+    }
+
+    _values.resize(2 * PROPERTIES_NB * _samplesNb);
+    for (int phase = 0; phase < 2; ++phase) {
+        for (int p = 0; p < PROPERTIES_NB; ++p) {
+            const auto [constant, curve] = property(*phases[phase], static_cast<Property>(p));
+            double *table = &_values[(phase * PROPERTIES_NB + p) * _samplesNb];
+
+            for (int k = 0; k < _samplesNb; ++k) {
+                const double T = _inverseStep > 0.0 ? _T0 + k / _inverseStep : _T0;
+                table[k] = curve->Empty() ? constant : (*curve)(T);
+            }
+        }
+    }
+}
+
+void FvmMaterialTable::Evaluate(const FvmVar &fvmVar) const {
+    PetscLogEventBegin(FvmLog::Event("FvmSetMaterialProperties"), 0, 0, 0, 0);
+
+    const bool energy = fvmVar.IsActive(FvmVar::FieldSet::ENERGY);
+    const bool vof = fvmVar.IsActive(FvmVar::FieldSet::VOF);
+
+    {
+        const FieldWrite dens(fvmVar.dens), visc(fvmVar.visc);
+        std::optional<FieldRead> xs, xs0, xT;
+        std::optional<FieldWrite> spheat, thcond;
+        if (vof) {
+            xs.emplace(fvmVar.xs);
+            xs0.emplace(fvmVar.xs0);
+        }
+        if (energy) {
+            xT.emplace(fvmVar.xT);
+            spheat.emplace(fvmVar.spheat);
+            thcond.emplace(fvmVar.thcond);
+        }
+
+        const int n = dens.Size();
+        const double last = _samplesNb - 1;
+        const double Tref = fvmParameter.tref;
+
+        const double *s = vof ? xs->Data() : nullptr;
+        const double *s0 = vof ? xs0->Data() : nullptr;
+        const double *T = energy ? xT->Data() : nullptr;
+        double *rho = dens.Data(), *mu = visc.Data();
+        double *cp = energy ? spheat->Data() : nullptr, *k = energy ? thcond->Data() : nullptr;
+
+        const double *rho1 = Table(0, DENSITY), *rho2 = Table(1, DENSITY);
+        const double *mu1 = Table(0, VISCOSITY), *mu2 = Table(1, VISCOSITY);
+        const double *cp1 = Table(0, SPECIFIC_HEAT), *cp2 = Table(1, SPECIFIC_HEAT);
+        const double *k1 = Table(0, CONDUCTIVITY), *k2 = Table(1, CONDUCTIVITY);
+
+        for (int i = 0; i < n; ++i) {
+            // Single phase runs take the first material only
+            const double fr = vof ? LMIN(LMAX(s[i] * 0.5 + s0[i] * 0.5, 0.0), 1.0) : 0.0;
+
+            // Grid position shared by every lookup of the cell
+            const double x = LMIN(LMAX(((energy ? T[i] : Tref) - _T0) * _inverseStep, 0.0), last);
+            const int j = LMIN(static_cast<int>(x), _samplesNb - 2);
+            const double t = x - j;
+
+            const auto lookup = [j, t, fr](const double *a, const double *b) {
+                const double va = a[j] + t * (a[j + 1] - a[j]);
+                const double vb = b[j] + t * (b[j + 1] - b[j]);
+                return va + fr * (vb - va);
+            };
+
+            rho[i] = lookup(rho1, rho2);
+            mu[i] = lookup(mu1, mu2);
+            if (energy) {
+                cp[i] = lookup(cp1, cp2);
+                k[i] = lookup(k1, k2);
+            }
+        }
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmSetMaterialProperties"), 0, 0, 0, 0);
+
+    if (energy) {
+        FvmVector::V_GhostUpdate({fvmVar.dens, fvmVar.visc, fvmVar.spheat, fvmVar.thcond});
+    } else {
+        FvmVector::V_GhostUpdate({fvmVar.dens, fvmVar.visc});
+    }
+}
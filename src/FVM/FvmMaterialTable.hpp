@@ -0,0 +1,48 @@
+#ifndef FVMMATERIALTABLE_HPP
+#define FVMMATERIALTABLE_HPP
+
+#include <vector>
+
+#include "FvmMaterial.hpp"
+
+class FvmVar;
+
+/**
+ * Cell material properties of a one or two phase run. Every property of
+ * both materials is sampled once on one uniform temperature grid spanning
+ * all material tables, so a cell needs one grid position shared by all
+ * lookups and each property is a branch-free linear interpolation between
+ * two samples. Constant properties are two equal samples.
+ *
+ * Evaluate() runs one pass over the local arrays of xs, xs0 and xT, then
+ * refreshes the ghosts of all property vectors in one fused exchange.
+ */
+class FvmMaterialTable {
+public:
+    FvmMaterialTable(const FvmMaterial &first, const FvmMaterial &second);
+
+    //! dens and visc, plus spheat and thcond when the energy fields are active
+    void Evaluate(const FvmVar &fvmVar) const;
+
+    //! Whether any property follows the temperature
+    [[nodiscard]] bool TemperatureDependent() const { return _samplesNb > 2; }
+
+private:
+    enum Property { DENSITY = 0, VISCOSITY, SPECIFIC_HEAT, CONDUCTIVITY, PROPERTIES_NB };
+
+    //! Grid samples of temperature-dependent runs; the grid error is
+    //! bounded by the curvature of the tables between two samples
+    static constexpr int tableSamples = 1024;
+
+    [[nodiscard]] const double *Table(int phase, Property property) const {
+        return &_values[(phase * PROPERTIES_NB + property) * _samplesNb];
+    }
+
+private:
+    double _T0 = 0.0; //! Temperature of the first sample
+    double _inverseStep = 0.0; //! 1 / grid spacing (0 for constant properties)
+    int _samplesNb = 2;
+    std::vector<double> _values; //! [phase][property][sample]
+};
+
+#endif
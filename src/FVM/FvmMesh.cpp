@@ -7,8 +7,19 @@
 #include <vtkMultiBlockDataSet.h>
 #include <vtkTetra.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <utility>
+
+#include "FvmFaceMap.hpp"
+#include "FvmMeshDistribute.hpp"
+#include "FvmMeshRenumber.hpp"
+#include "FvmLog.hpp"
 #include "GeoCalc.hpp"
 #include "FvmParam.hpp"
+#include "FvmThreads.hpp"
 #include "Globals.hpp"
 
 #include "petscksp.h"
@@ -77,29 +88,34 @@ ElementType GetSurfaceElementType(const int nodesNb) {
 }
 
 
-std::vector<int> GetFaceVertices(const netgen::Element2d &elem) {
+FaceVertices MakeFaceVertices(std::initializer_list<int> verts) {
+    FaceVertices face;
+    for (const int v: verts)
+        face.v[face.n++] = v;
+    return face;
+}
+
+FaceVertices GetFaceVertices(const netgen::Element2d &elem) {
     const auto &verts = elem.Vertices();
 
     switch (elem.GetType()) {
-        case TRIG: return {verts[0], verts[1], verts[2]};
-        case QUAD: return {verts[0], verts[1], verts[2], verts[3]};
+        case TRIG: return MakeFaceVertices({verts[0], verts[1], verts[2]});
+        case QUAD: return MakeFaceVertices({verts[0], verts[1], verts[2], verts[3]});
         default:
             throw std::runtime_error("Unsupported element type for face extraction");
     }
 }
 
-std::vector<int> GetFaceVertices(
-    const netgen::Element &elem, const int faceIndex) {
-    const auto &verts = elem.Vertices();
-
-    switch (elem.GetType()) {
+template<typename Vertices>
+FaceVertices GetFaceVertices(const int ngType, const Vertices &verts, const int faceIndex) {
+    switch (ngType) {
         case TET:
         case TET10:
             switch (faceIndex) {
-                case 0: return {verts[0], verts[1], verts[2]};
-                case 1: return {verts[0], verts[1], verts[3]};
-                case 2: return {verts[1], verts[2], verts[3]};
-                case 3: return {verts[2], verts[0], verts[3]};
+                case 0: return MakeFaceVertices({verts[0], verts[1], verts[2]});
+                case 1: return MakeFaceVertices({verts[0], verts[1], verts[3]});
+                case 2: return MakeFaceVertices({verts[1], verts[2], verts[3]});
+                case 3: return MakeFaceVertices({verts[2], verts[0], verts[3]});
                 default: break;
             }
             break;
@@ -108,12 +124,12 @@ std::vector<int> GetFaceVertices(
         case HEX20:
         case HEX7:
             switch (faceIndex) {
-                case 0: return {verts[0], verts[1], verts[2], verts[3]};
-                case 1: return {verts[4], verts[5], verts[6], verts[7]};
-                case 2: return {verts[0], verts[1], verts[5], verts[4]};
-                case 3: return {verts[1], verts[2], verts[6], verts[5]};
-                case 4: return {verts[2], verts[3], verts[7], verts[6]};
-                case 5: return {verts[3], verts[0], verts[4], verts[7]};
+                case 0: return MakeFaceVertices({verts[0], verts[1], verts[2], verts[3]});
+                case 1: return MakeFaceVertices({verts[4], verts[5], verts[6], verts[7]});
+                case 2: return MakeFaceVertices({verts[0], verts[1], verts[5], verts[4]});
+                case 3: return MakeFaceVertices({verts[1], verts[2], verts[6], verts[5]});
+                case 4: return MakeFaceVertices({verts[2], verts[3], verts[7], verts[6]});
+                case 5: return MakeFaceVertices({verts[3], verts[0], verts[4], verts[7]});
                 default: break;
             }
             break;
@@ -121,11 +137,11 @@ std::vector<int> GetFaceVertices(
         case PYRAMID:
         case PYRAMID13:
             switch (faceIndex) {
-                case 0: return {verts[0], verts[1], verts[2], verts[3]}; // base
-                case 1: return {verts[0], verts[1], verts[4]}; // side
-                case 2: return {verts[1], verts[2], verts[4]};
-                case 3: return {verts[2], verts[3], verts[4]};
-                case 4: return {verts[3], verts[0], verts[4]};
+                case 0: return MakeFaceVertices({verts[0], verts[1], verts[2], verts[3]}); // base
+                case 1: return MakeFaceVertices({verts[0], verts[1], verts[4]}); // side
+                case 2: return MakeFaceVertices({verts[1], verts[2], verts[4]});
+                case 3: return MakeFaceVertices({verts[2], verts[3], verts[4]});
+                case 4: return MakeFaceVertices({verts[3], verts[0], verts[4]});
                 default: break;
             }
             break;
@@ -134,11 +150,11 @@ std::vector<int> GetFaceVertices(
         case PRISM12:
         case PRISM15:
             switch (faceIndex) {
-                case 0: return {verts[0], verts[1], verts[2]}; // base
-                case 1: return {verts[3], verts[4], verts[5]}; // top
-                case 2: return {verts[0], verts[1], verts[4], verts[3]};
-                case 3: return {verts[1], verts[2], verts[5], verts[4]};
-                case 4: return {verts[2], verts[0], verts[3], verts[5]};
+                case 0: return MakeFaceVertices({verts[0], verts[1], verts[2]}); // base
+                case 1: return MakeFaceVertices({verts[3], verts[4], verts[5]}); // top
+                case 2: return MakeFaceVertices({verts[0], verts[1], verts[4], verts[3]});
+                case 3: return MakeFaceVertices({verts[1], verts[2], verts[5], verts[4]});
+                case 4: return MakeFaceVertices({verts[2], verts[0], verts[3], verts[5]});
                 default: break;
             }
             break;
@@ -150,12 +166,31 @@ std::vector<int> GetFaceVertices(
     throw std::runtime_error("Invalid face index for element type");
 }
 
+FaceVertices GetFaceVertices(const netgen::Element &elem, const int faceIndex) {
+    return GetFaceVertices(elem.GetType(), elem.Vertices(), faceIndex);
+}
+
 FvmMeshContainer::FvmMeshContainer(const std::shared_ptr<MeshObject> &meshObject) {
     this->SetProcNumber(meshObject->GetProcNumber());
 
     this->BuildFvmMesh(meshObject);
+    this->RenumberMesh();
     this->ComputeVolumes();
     this->ComputeFaces();
+    this->BuildStorage();
+    this->ComputeMeshProperties();
+}
+
+FvmMeshContainer::FvmMeshContainer(const LocalMeshData &localMesh)
+    : _distributed(true) {
+    this->SetProcNumber(static_cast<int>(localMesh.cellOffsets.size()) - 1);
+
+    this->BuildLocalFvmMesh(localMesh);
+    this->ComputeVolumes();
+    this->ComputeFaces();
+    this->SetProcessorPatches();
+    this->SetSharedFaces();
+    this->BuildStorage();
     this->ComputeMeshProperties();
 }
 
@@ -215,80 +250,95 @@ void FvmMeshContainer::BuildFvmMesh(const std::shared_ptr<MeshObject> &meshObjec
     }
 
     // PHYSICAL GEOMETRY REGIONS
-    std::map<std::set<int>, std::pair<int, int> > boundaryFaceRegions;
-    for (int i = 0; i < meshObject->GetNSE(); ++i) {
-        const auto &se = meshObject->SurfaceElement(i + 1);
-        std::set<int> seVerts(se.Vertices().begin(), se.Vertices().end());
+    PetscLogEventBegin(FvmLog::Event("FvmFaceMatching"), 0, 0, 0, 0);
 
-        int regionIndex = se.GetIndex();
-        int partitionId = 1; // default partition ID
-        if (IsParallel())
-            partitionId = meshObject->surf_partition[i];
+    // boundary face key -> surface element index
+    const int surfElementsNb = static_cast<int>(meshObject->GetNSE());
+    FaceHashMap boundaryFaceMap(surfElementsNb);
+    for (int i = 0; i < surfElementsNb; ++i) {
+        const auto &se = meshObject->SurfaceElement(i + 1);
+        const auto &seVerts = se.Vertices();
+        std::array<int, MAX_FACE_NODES> verts{};
+        const int vertsNb = std::min(static_cast<int>(seVerts.size()), MAX_FACE_NODES);
+        std::copy_n(seVerts.begin(), vertsNb, verts.begin());
 
-        boundaryFaceRegions[seVerts] = std::make_pair(regionIndex, partitionId);
+        boundaryFaceMap.InsertOrAssign(MakeFaceKey(verts.data(), vertsNb), i);
     }
 
     // FACES
     faces.clear();
     int faceIndex = 0;
-    std::map<std::set<int>, int> faceMap; // unique set of nodes -> face index
     if (volumeMesh) {
+        // Every interior face is seen twice, boundary faces once
+        std::size_t elementFacesNb = 0;
+        for (const auto &element: elements)
+            elementFacesNb += element.facesNb;
+        faces.reserve((elementFacesNb + surfElementsNb) / 2);
+
+        FaceHashMap faceMap((elementFacesNb + surfElementsNb) / 2); // face key -> face index
         for (int e = 0; e < elementsNb; ++e) {
             const auto &elem = meshObject->VolumeElement(e + 1);
             for (int f = 0; f < elem.GetNFaces(); ++f) {
-                auto faceVerts = GetFaceVertices(elem, f);
-                std::set<int> faceKey(faceVerts.begin(), faceVerts.end());
+                const FaceVertices faceVerts = GetFaceVertices(elem, f);
+                const FaceKey faceKey = MakeFaceKey(faceVerts);
 
-                auto it = faceMap.find(faceKey);
-                if (it == faceMap.end()) {
+                auto [index, inserted] = faceMap.TryEmplace(faceKey, faceIndex);
+                if (inserted) {
                     FvmMesh::Face face;
                     face.index = faceIndex;
-                    face.nodes.assign(faceVerts.begin(), faceVerts.end());
-                    face.nodesNb = static_cast<int>(face.nodes.size());
+                    face.nodes.assign(faceVerts.v.begin(), faceVerts.v.begin() + faceVerts.n);
+                    face.nodesNb = faceVerts.n;
                     face.owner = e;
                     face.type = GetSurfaceElementType(face.nodesNb);
-                    faceMap[faceKey] = faceIndex;
 
                     // Get physical geometry region index
-                    auto bfit = boundaryFaceRegions.find(faceKey);
-                    if (bfit != boundaryFaceRegions.end()) {
-                        face.physReg = bfit->second.first;
-                        face.procId = bfit->second.second;
+                    const int se = boundaryFaceMap.Find(faceKey);
+                    if (se != -1) {
+                        face.physReg = meshObject->SurfaceElement(se + 1).GetIndex();
+                        face.procId = IsParallel() ? meshObject->surf_partition[se] : 1;
                     } else {
                         // volume physical region receives an ID equivalent to the number of surfaces + 1
                         face.physReg = meshObject->GetNFD() + elem.GetIndex();
                     }
 
-                    faces.push_back(face);
+                    faces.push_back(std::move(face));
                     elements[e].faces[f] = faceIndex;
                     ++faceIndex;
                 } else {
                     // Existing face (shared with another element)
-                    const int sharedFaceIndex = it->second;
-                    faces[sharedFaceIndex].pair = e;
-                    elements[e].faces[f] = sharedFaceIndex;
+                    faces[index].pair = e;
+                    elements[e].faces[f] = index;
                 }
             }
         }
+
+        if (verbose) {
+            PetscPrintf(PETSC_COMM_WORLD, "Face matching table: %zu keys, %.1f MB\n",
+                        faceMap.Size(), faceMap.MemoryBytes() / 1048576.0);
+        }
     } else {
-        for (int e = 0; e < static_cast<int>(meshObject->GetNSE()); ++e) {
+        faces.reserve(surfElementsNb);
+        for (int e = 0; e < surfElementsNb; ++e) {
             const auto &elem = meshObject->SurfaceElement(e + 1);
-            auto faceVerts = GetFaceVertices(elem);
+            const FaceVertices faceVerts = GetFaceVertices(elem);
 
             FvmMesh::Face face;
             face.index = faceIndex;
-            face.nodes.assign(faceVerts.begin(), faceVerts.end());
-            face.nodesNb = static_cast<int>(face.nodes.size());
+            face.nodes.assign(faceVerts.v.begin(), faceVerts.v.begin() + faceVerts.n);
+            face.nodesNb = faceVerts.n;
             face.owner = e;
             face.type = GetSurfaceElementType(face.nodesNb);
 
-            faces.push_back(face);
+            faces.push_back(std::move(face));
             elements[e].faces[0] = faceIndex; // only one face
             ++faceIndex;
         }
     }
 
+    PetscLogEventEnd(FvmLog::Event("FvmFaceMatching"), 0, 0, 0, 0);
+
     facesNb = static_cast<int>(faces.size());
+    ownedFacesNb = facesNb;
 
     // PATCHES
     patches.clear();
@@ -311,133 +361,323 @@ void FvmMeshContainer::BuildFvmMesh(const std::shared_ptr<MeshObject> &meshObjec
     _physicalVolumeRegions = meshObject->GetVolumeRegions();
 }
 
-void FvmMeshContainer::ComputeFaces() {
-    for (auto &face: faces) {
-        if (face.type == ElementType::TRIANGLE) {
-            const Vector3 &n1 = nodes[face.nodes[0] - 1];
-            const Vector3 &n2 = nodes[face.nodes[1] - 1];
-            const Vector3 &n3 = nodes[face.nodes[2] - 1];
-
-            face.Aj = GeoCalcTriArea(n1, n2, n3);
-            face.cVec = GeoCalcCentroid3(n1, n2, n3);
-            face.nVec = GeoCalcNormal(n1, n2, n3);
-        } else if (face.type == ElementType::QUADRANGLE) {
-            const Vector3 &n1 = nodes[face.nodes[0] - 1];
-            const Vector3 &n2 = nodes[face.nodes[1] - 1];
-            const Vector3 &n3 = nodes[face.nodes[2] - 1];
-            const Vector3 &n4 = nodes[face.nodes[3] - 1];
-
-            face.Aj = GeoCalcQuadArea(n1, n2, n3, n4);
-            face.cVec = GeoCalcCentroid4(n1, n2, n3, n4);
-            face.nVec = GeoCalcNormal(n1, n2, n3);
-        }
+void FvmMeshContainer::RenumberMesh() {
+    const auto ordering = static_cast<CellOrdering>(fvmParameter.renumber);
+    if (ordering != CellOrdering::RCM && ordering != CellOrdering::HILBERT)
+        return;
 
-        face.aVec = GeoMultScalarVector(face.Aj, face.nVec);
-        face.rpl = GeoSubVectorVector(
-            face.cVec, GeoMultScalarVector(
-                GeoDotVectorVector(
-                    GeoSubVectorVector(face.cVec, elements[face.owner].cVec), face.nVec), face.nVec));
+    PetscLogEventBegin(FvmLog::Event("FvmRenumber"), 0, 0, 0, 0);
 
-        if (face.pair != -1) {
-            const int neighbour = face.pair;
+    const MatrixProfile before = ComputeMatrixProfile(*this);
+    ApplyCellOrdering(*this, ComputeCellOrdering(*this, ordering));
+    const MatrixProfile after = ComputeMatrixProfile(*this);
 
-            Vector3 diff = GeoSubVectorVector(elements[neighbour].cVec, elements[face.owner].cVec);
-            // Normal should point to neighbour - flip normal if necessary
-            if (GeoDotVectorVector(diff, face.nVec) < 0) {
-                face.nVec = GeoMultScalarVector(-1.0, face.nVec);
-            }
+    PetscLogEventEnd(FvmLog::Event("FvmRenumber"), 0, 0, 0, 0);
 
-            face.rnl = GeoSubVectorVector(
-                face.cVec, GeoMultScalarVector(
-                    GeoDotVectorVector(
-                        GeoSubVectorVector(face.cVec, elements[neighbour].cVec), face.nVec), face.nVec));
+    PetscPrintf(PETSC_COMM_WORLD, "Cell renumbering (%s):\n",
+                ordering == CellOrdering::RCM ? "reverse Cuthill-McKee" : "Hilbert curve");
+    PetscPrintf(PETSC_COMM_WORLD, "  Bandwidth: \t\t\t%d -> %d\n", before.bandwidth, after.bandwidth);
+    PetscPrintf(PETSC_COMM_WORLD, "  Profile: \t\t\t%lld -> %lld\n", before.profile, after.profile);
+}
 
-            face.dVec = GeoSubVectorVector(face.rnl, face.rpl);
-            face.dj = GeoMagVector(face.dVec);
-            if (face.dj == 0) {
-                PetscPrintf(PETSC_COMM_WORLD, "\nError: Problem with mesh\n");
-                throw FvmException("Invalid mesh (Direction vector length == 0)", LOGICAL_ERROR);
-            }
-        } else {
-            face.dVec = GeoSubVectorVector(face.cVec, face.rpl);
-            face.dj = GeoMagVector(face.dVec);
-            if (face.dj == 0) {
-                PetscPrintf(PETSC_COMM_WORLD, "\nError: Problem with mesh\n");
-                throw FvmException("Invalid mesh (Direction vector length == 0)", LOGICAL_ERROR);
+void FvmMeshContainer::BuildLocalFvmMesh(const LocalMeshData &localMesh) {
+    PetscPrintf(PETSC_COMM_WORLD, "\nCreating distributed FVM mesh...\n");
+
+    cellOffset = localMesh.cellOffset;
+    cellOffsets = localMesh.cellOffsets;
+
+    // NODES
+    nodesNb = static_cast<int>(localMesh.nodes.size());
+    nodes = localMesh.nodes;
+
+    // ELEMENTS
+    elementsNb = localMesh.CellsNumber();
+    elements.resize(elementsNb);
+
+    for (int i = 0; i < elementsNb; ++i) {
+        const auto verts = localMesh.cellNodes.Row(i);
+        FvmMesh::Element &fvmElement = elements[i];
+
+        fvmElement.index = i;
+        fvmElement.type = ConvertNetgenElementType(localMesh.cellTypes[i]);
+        fvmElement.nodesNb = static_cast<int>(verts.size());
+        fvmElement.nodes.assign(verts.begin(), verts.end());
+        fvmElement.facesNb = localMesh.cellFacesNb[i];
+        fvmElement.faces.resize(fvmElement.facesNb, -1);
+        fvmElement.phyReg = localMesh.cellRegions[i];
+        fvmElement.procId = localMesh.rank;
+    }
+
+    // PHYSICAL GEOMETRY REGIONS
+    PetscLogEventBegin(FvmLog::Event("FvmFaceMatching"), 0, 0, 0, 0);
+
+    const int surfElementsNb = localMesh.surfNodes.Size();
+    FaceHashMap boundaryFaceMap(surfElementsNb);
+    for (int i = 0; i < surfElementsNb; ++i) {
+        const auto verts = localMesh.surfNodes.Row(i);
+        const int vertsNb = std::min(static_cast<int>(verts.size()), MAX_FACE_NODES);
+        boundaryFaceMap.InsertOrAssign(MakeFaceKey(verts.data(), vertsNb), i);
+    }
+
+    // FACES
+    faces.clear();
+    int faceIndex = 0;
+
+    std::size_t elementFacesNb = 0;
+    for (const auto &element: elements)
+        elementFacesNb += element.facesNb;
+    faces.reserve((elementFacesNb + surfElementsNb) / 2);
+
+    FaceHashMap faceMap((elementFacesNb + surfElementsNb) / 2); // face key -> face index
+    for (int e = 0; e < elementsNb; ++e) {
+        const auto verts = localMesh.cellNodes.Row(e);
+        for (int f = 0; f < elements[e].facesNb; ++f) {
+            const FaceVertices faceVerts = GetFaceVertices(localMesh.cellTypes[e], verts, f);
+            const FaceKey faceKey = MakeFaceKey(faceVerts);
+
+            auto [index, inserted] = faceMap.TryEmplace(faceKey, faceIndex);
+            if (inserted) {
+                FvmMesh::Face face;
+                face.index = faceIndex;
+                face.nodes.assign(faceVerts.v.begin(), faceVerts.v.begin() + faceVerts.n);
+                face.nodesNb = faceVerts.n;
+                face.owner = e;
+                face.type = GetSurfaceElementType(face.nodesNb);
+
+                // Get physical geometry region index
+                const int se = boundaryFaceMap.Find(faceKey);
+                if (se != -1) {
+                    face.physReg = localMesh.surfRegions[se];
+                    face.procId = localMesh.surfPartitions[se];
+                } else {
+                    // volume physical region receives an ID equivalent to the number of surfaces + 1
+                    face.physReg = localMesh.surfaceDescriptorsNb + localMesh.cellRegions[e];
+                }
+
+                faces.push_back(std::move(face));
+                elements[e].faces[f] = faceIndex;
+                ++faceIndex;
+            } else {
+                // Existing face (shared with another element)
+                faces[index].pair = e;
+                elements[e].faces[f] = index;
             }
         }
+    }
 
-        // face.elemReg = -1;
-        face.bc = BndCondType::NONE;
+    facesNb = static_cast<int>(faces.size());
+
+    // PROCESSOR FACES
+    // Every unpaired face is matched across ranks: a partition interface may also be a region
+    // interface carrying a surface element, so only the neighbour partition tells them apart
+    std::vector<int> candidates;
+    std::vector<FaceKey> candidateKeys;
+    std::vector<int> candidateCells;
+    for (const auto &face: faces) {
+        if (face.pair != -1)
+            continue;
+
+        std::array<int, MAX_FACE_NODES> globalKey{};
+        for (int n = 0; n < face.nodesNb; ++n)
+            globalKey[n] = localMesh.nodeGlobalIds[face.nodes[n] - 1];
+
+        candidates.push_back(face.index);
+        candidateKeys.push_back(MakeFaceKey(globalKey.data(), face.nodesNb));
+        candidateCells.push_back(cellOffset + face.owner);
     }
 
-    for (auto &patch: patches) {
-        if (patch.type == ElementType::TRIANGLE) {
-            const Vector3 &n1 = nodes[patch.nodes[0] - 1];
-            const Vector3 &n2 = nodes[patch.nodes[1] - 1];
-            const Vector3 &n3 = nodes[patch.nodes[2] - 1];
-
-            patch.Aj = GeoCalcTriArea(n1, n2, n3);
-            patch.cVec = GeoCalcCentroid3(n1, n2, n3);
-            patch.nVec = GeoCalcNormal(n1, n2, n3);
+    const auto neighbours = ExchangeInterfaceFaces(candidateKeys, candidateCells, PETSC_COMM_WORLD);
+
+    _processorFaces.clear();
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (neighbours[i] == -1)
+            continue;
+
+        FvmMesh::Face &face = faces[candidates[i]];
+        face.physReg = neighbours[i]; // global ID of the ghost cell
+        face.procId = GetCellOwner(neighbours[i]);
+        face.bc = BndCondType::PROCESSOR;
+        _processorFaces.push_back(face.index);
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmFaceMatching"), 0, 0, 0, 0);
+
+    // PATCHES
+    patches.clear();
+    for (const auto &face: faces) {
+        if (face.pair == -1) {
+            patches.push_back(face);
         }
     }
+
+    patchesNb = static_cast<int>(patches.size());
+
+    _physicalSurfaceRegions = localMesh.surfaceRegions;
+    _physicalVolumeRegions = localMesh.volumeRegions;
 }
 
-void FvmMeshContainer::ComputeVolumes() {
-    for (auto &element: elements) {
-        element.Vp = 0.0;
-        element.cVec = {0.0, 0.0, 0.0};
-
-        const auto &verts = element.nodes;
-
-        if (element.type == ElementType::TRIANGLE) {
-            const Vector3 &n1 = nodes[verts[0] - 1];
-            const Vector3 &n2 = nodes[verts[1] - 1];
-            const Vector3 &n3 = nodes[verts[2] - 1];
-
-            element.Vp = 0.0;
-            element.cVec = GeoCalcCentroid3(n1, n2, n3);
-        } else if (element.type == ElementType::QUADRANGLE) {
-            const Vector3 &n1 = nodes[verts[0] - 1];
-            const Vector3 &n2 = nodes[verts[1] - 1];
-            const Vector3 &n3 = nodes[verts[2] - 1];
-            const Vector3 &n4 = nodes[verts[3] - 1];
-
-            element.Vp = 0.0;
-            element.cVec = GeoCalcCentroid4(n1, n2, n3, n4);
-        } else if (element.type == ElementType::TETRAHEDRON) {
-            const auto &n1 = nodes[verts[0] - 1];
-            const auto &n2 = nodes[verts[1] - 1];
-            const auto &n3 = nodes[verts[2] - 1];
-            const auto &n4 = nodes[verts[3] - 1];
-
-            element.Vp = GeoCalcTetraVolume(n1, n2, n3, n4);
-            element.cVec = GeoCalcCentroid4(n1, n2, n3, n4);
-        } else if (element.type == ElementType::HEXAHEDRON) {
-            const auto &n1 = nodes[verts[0] - 1];
-            const auto &n2 = nodes[verts[1] - 1];
-            const auto &n3 = nodes[verts[2] - 1];
-            const auto &n4 = nodes[verts[3] - 1];
-            const auto &n5 = nodes[verts[4] - 1];
-            const auto &n6 = nodes[verts[5] - 1];
-            const auto &n7 = nodes[verts[6] - 1];
-            const auto &n8 = nodes[verts[7] - 1];
-
-            element.Vp = GeoCalcHexaVolume(n1, n2, n3, n4, n5, n6, n7, n8);
-            element.cVec = GeoCalcCentroid8(n1, n2, n3, n4, n5, n6, n7, n8);
-        } else if (element.type == ElementType::PRISM) {
-            const auto &n1 = nodes[verts[0] - 1];
-            const auto &n2 = nodes[verts[1] - 1];
-            const auto &n3 = nodes[verts[2] - 1];
-            const auto &n4 = nodes[verts[3] - 1];
-            const auto &n5 = nodes[verts[4] - 1];
-            const auto &n6 = nodes[verts[5] - 1];
-
-            element.Vp = GeoCalcPrismVolume(n1, n2, n3, n4, n5, n6);
-            element.cVec = GeoCalcCentroid6(n1, n2, n3, n4, n5, n6);
+void FvmMeshContainer::SetProcessorPatches() {
+    // ComputeFaces resets face boundary types
+    ghosts.clear();
+    ghosts.reserve(_processorFaces.size());
+
+    for (const int index: _processorFaces) {
+        FvmMesh::Face &face = faces[index];
+        face.bc = BndCondType::PROCESSOR;
+        face.ghost = elementsNb + static_cast<int>(ghosts.size());
+        ghosts.push_back(face.physReg);
+    }
+
+    ghostsNb = static_cast<int>(ghosts.size());
+}
+
+void FvmMeshContainer::SetSharedFaces() {
+    auto isShared = [this](const FvmMesh::Face &face) {
+        return face.bc == BndCondType::PROCESSOR && face.physReg < cellOffset + face.owner;
+    };
+
+    // Owned faces first, shared copies last
+    std::vector<int> order(faces.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_partition(order.begin(), order.end(), [&](const int i) { return !isShared(faces[i]); });
+    PermuteFaces(*this, order);
+
+    _processorFaces.clear();
+    ownedFacesNb = facesNb;
+    for (const auto &face: faces) {
+        if (face.bc != BndCondType::PROCESSOR)
+            continue;
+
+        _processorFaces.push_back(face.index);
+        if (isShared(face))
+            ownedFacesNb = std::min(ownedFacesNb, face.index);
+    }
+
+    faceOffset = 0;
+    MPI_Exscan(&ownedFacesNb, &faceOffset, 1, MPI_INT, MPI_SUM, PETSC_COMM_WORLD);
+
+    std::vector<SharedFace> owned, shared;
+    for (const int index: _processorFaces) {
+        const FvmMesh::Face &face = faces[index];
+        const int cell = cellOffset + face.owner;
+        if (index < ownedFacesNb)
+            owned.push_back({face.procId, cell, face.physReg, faceOffset + index});
+        else
+            shared.push_back({face.procId, face.physReg, cell, -1});
+    }
+
+    faceGhosts = ExchangeSharedFaceIds(owned, shared, PETSC_COMM_WORLD);
+}
+
+int FvmMeshContainer::GetCellOwner(const int globalIndex) const {
+    if (cellOffsets.empty())
+        return 0;
+
+    const auto it = std::upper_bound(cellOffsets.begin(), cellOffsets.end(), globalIndex);
+    return static_cast<int>(it - cellOffsets.begin()) - 1;
+}
+
+void FvmMeshContainer::ComputeFaces() {
+    PetscLogEventBegin(FvmLog::Event("FvmFaceGeometry"), 0, 0, 0, 0);
+
+    const int threadsNb = ThreadsNumber();
+
+    // Workers only count the degenerate faces: the report and the throw happen on this thread
+    std::atomic<int> invalidFaces{0};
+    ParallelFor(static_cast<int>(faces.size()), threadsNb, [this, &invalidFaces](const int begin, const int end) {
+        for (int i = begin; i < end; ++i) {
+            if (!ComputeFaceGeometry(faces[i]))
+                invalidFaces.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    ParallelFor(static_cast<int>(patches.size()), threadsNb, [this](const int begin, const int end) {
+        for (int i = begin; i < end; ++i)
+            ComputePatchGeometry(patches[i]);
+    });
+
+    PetscLogEventEnd(FvmLog::Event("FvmFaceGeometry"), 0, 0, 0, 0);
+
+    if (invalidFaces.load() > 0) {
+        PetscPrintf(PETSC_COMM_WORLD, "\nError: Problem with mesh (%d faces)\n", invalidFaces.load());
+        throw FvmException("Invalid mesh (Direction vector length == 0)", LOGICAL_ERROR);
+    }
+}
+
+bool FvmMeshContainer::ComputeFaceGeometry(FvmMesh::Face &face) const {
+    if (face.type == ElementType::TRIANGLE) {
+        const Vector3 &n1 = nodes[face.nodes[0] - 1];
+        const Vector3 &n2 = nodes[face.nodes[1] - 1];
+        const Vector3 &n3 = nodes[face.nodes[2] - 1];
+
+        face.Aj = GeoCalcTriArea(n1, n2, n3);
+        face.cVec = GeoCalcCentroid3(n1, n2, n3);
+        face.nVec = GeoCalcNormal(n1, n2, n3);
+    } else if (face.type == ElementType::QUADRANGLE) {
+        const Vector3 &n1 = nodes[face.nodes[0] - 1];
+        const Vector3 &n2 = nodes[face.nodes[1] - 1];
+        const Vector3 &n3 = nodes[face.nodes[2] - 1];
+        const Vector3 &n4 = nodes[face.nodes[3] - 1];
+
+        face.Aj = GeoCalcQuadArea(n1, n2, n3, n4);
+        face.cVec = GeoCalcCentroid4(n1, n2, n3, n4);
+        face.nVec = GeoCalcNormal(n1, n2, n3);
+    }
+
+    face.aVec = GeoMultScalarVector(face.Aj, face.nVec);
+    face.rpl = GeoSubVectorVector(
+        face.cVec, GeoMultScalarVector(
+            GeoDotVectorVector(
+                GeoSubVectorVector(face.cVec, elements[face.owner].cVec), face.nVec), face.nVec));
+
+    if (face.pair != -1) {
+        const int neighbour = face.pair;
+
+        Vector3 diff = GeoSubVectorVector(elements[neighbour].cVec, elements[face.owner].cVec);
+        // Normal should point to neighbour - flip normal if necessary
+        if (GeoDotVectorVector(diff, face.nVec) < 0) {
+            face.nVec = GeoMultScalarVector(-1.0, face.nVec);
         }
+
+        face.rnl = GeoSubVectorVector(
+            face.cVec, GeoMultScalarVector(
+                GeoDotVectorVector(
+                    GeoSubVectorVector(face.cVec, elements[neighbour].cVec), face.nVec), face.nVec));
+
+        face.dVec = GeoSubVectorVector(face.rnl, face.rpl);
+    } else {
+        face.dVec = GeoSubVectorVector(face.cVec, face.rpl);
     }
+    face.dj = GeoMagVector(face.dVec);
+    face.kj = face.Aj * GeoDotVectorVector(face.nVec, face.dVec);
+
+    // face.elemReg = -1;
+    face.bc = BndCondType::NONE;
+
+    return face.dj != 0;
+}
+
+void FvmMeshContainer::ComputePatchGeometry(FvmMesh::Face &patch) const {
+    if (patch.type == ElementType::TRIANGLE) {
+        const Vector3 &n1 = nodes[patch.nodes[0] - 1];
+        const Vector3 &n2 = nodes[patch.nodes[1] - 1];
+        const Vector3 &n3 = nodes[patch.nodes[2] - 1];
+
+        patch.Aj = GeoCalcTriArea(n1, n2, n3);
+        patch.cVec = GeoCalcCentroid3(n1, n2, n3);
+        patch.nVec = GeoCalcNormal(n1, n2, n3);
+    }
+}
+
+void FvmMeshContainer::ComputeVolumes() {
+    PetscLogEventBegin(FvmLog::Event("FvmCellGeometry"), 0, 0, 0, 0);
+
+    ParallelFor(static_cast<int>(elements.size()), ThreadsNumber(), [this](const int begin, const int end) {
+        for (int i = begin; i < end; ++i)
+            ComputeElementGeometry(elements[i]);
+    });
+
+    PetscLogEventEnd(FvmLog::Event("FvmCellGeometry"), 0, 0, 0, 0);
 
     auto [minIt, maxIt] = std::minmax_element(elements.begin(), elements.end(),
                                               [](const FvmMesh::Element &a, const FvmMesh::Element &b) {
@@ -452,6 +692,133 @@ void FvmMeshContainer::ComputeVolumes() {
     }
 }
 
+void FvmMeshContainer::ComputeElementGeometry(FvmMesh::Element &element) const {
+    element.Vp = 0.0;
+    element.cVec = {0.0, 0.0, 0.0};
+
+    const auto &verts = element.nodes;
+
+    if (element.type == ElementType::TRIANGLE) {
+        const Vector3 &n1 = nodes[verts[0] - 1];
+        const Vector3 &n2 = nodes[verts[1] - 1];
+        const Vector3 &n3 = nodes[verts[2] - 1];
+
+        element.Vp = 0.0;
+        element.cVec = GeoCalcCentroid3(n1, n2, n3);
+    } else if (element.type == ElementType::QUADRANGLE) {
+        const Vector3 &n1 = nodes[verts[0] - 1];
+        const Vector3 &n2 = nodes[verts[1] - 1];
+        const Vector3 &n3 = nodes[verts[2] - 1];
+        const Vector3 &n4 = nodes[verts[3] - 1];
+
+        element.Vp = 0.0;
+        element.cVec = GeoCalcCentroid4(n1, n2, n3, n4);
+    } else if (element.type == ElementType::TETRAHEDRON) {
+        const auto &n1 = nodes[verts[0] - 1];
+        const auto &n2 = nodes[verts[1] - 1];
+        const auto &n3 = nodes[verts[2] - 1];
+        const auto &n4 = nodes[verts[3] - 1];
+
+        element.Vp = GeoCalcTetraVolume(n1, n2, n3, n4);
+        element.cVec = GeoCalcCentroid4(n1, n2, n3, n4);
+    } else if (element.type == ElementType::HEXAHEDRON) {
+        const auto &n1 = nodes[verts[0] - 1];
+        const auto &n2 = nodes[verts[1] - 1];
+        const auto &n3 = nodes[verts[2] - 1];
+        const auto &n4 = nodes[verts[3] - 1];
+        const auto &n5 = nodes[verts[4] - 1];
+        const auto &n6 = nodes[verts[5] - 1];
+        const auto &n7 = nodes[verts[6] - 1];
+        const auto &n8 = nodes[verts[7] - 1];
+
+        element.Vp = GeoCalcHexaVolume(n1, n2, n3, n4, n5, n6, n7, n8);
+        element.cVec = GeoCalcCentroid8(n1, n2, n3, n4, n5, n6, n7, n8);
+    } else if (element.type == ElementType::PRISM) {
+        const auto &n1 = nodes[verts[0] - 1];
+        const auto &n2 = nodes[verts[1] - 1];
+        const auto &n3 = nodes[verts[2] - 1];
+        const auto &n4 = nodes[verts[3] - 1];
+        const auto &n5 = nodes[verts[4] - 1];
+        const auto &n6 = nodes[verts[5] - 1];
+
+        element.Vp = GeoCalcPrismVolume(n1, n2, n3, n4, n5, n6);
+        element.cVec = GeoCalcCentroid6(n1, n2, n3, n4, n5, n6);
+    }
+}
+
+void FvmMeshContainer::BuildStorage() {
+    if (_releasedBytes > 0)
+        throw FvmException("Mesh storage rebuilt after its connectivity was released", LOGICAL_ERROR);
+
+    storage.Build(*this);
+    BuildDerived();
+}
+
+void FvmMeshContainer::BuildStorage(Csr elementNodes, Csr elementFaces, Csr faceNodes) {
+    if (_releasedBytes > 0)
+        throw FvmException("Mesh storage rebuilt after its connectivity was released", LOGICAL_ERROR);
+
+    storage.Build(*this, std::move(elementNodes), std::move(elementFaces), std::move(faceNodes));
+
+    // The structs only get their lists back when they are to be kept
+    if (fvmParameter.keepconn == LOGICAL_TRUE) {
+        for (int i = 0; i < static_cast<int>(faces.size()); ++i) {
+            const auto row = storage.faceNodes.Row(i);
+            faces[i].nodes.assign(row.begin(), row.end());
+        }
+        for (int i = 0; i < static_cast<int>(elements.size()); ++i) {
+            const auto nodesRow = storage.elementNodes.Row(i);
+            const auto facesRow = storage.elementFaces.Row(i);
+            elements[i].nodes.assign(nodesRow.begin(), nodesRow.end());
+            elements[i].faces.assign(facesRow.begin(), facesRow.end());
+        }
+    }
+
+    BuildDerived();
+}
+
+void FvmMeshContainer::BuildDerived() {
+    faceCoefficients.Build(storage);
+    regionIndex.Build(*this);
+    faceSplit.Build(storage);
+
+    if (fvmParameter.keepconn != LOGICAL_TRUE)
+        ReleaseConnectivity();
+}
+
+void FvmMeshContainer::ReleaseConnectivity() {
+    const std::size_t before = FvmMeshStorage::ContainerMemoryBytes(*this);
+
+    for (auto &face: faces)
+        std::vector<int>().swap(face.nodes);
+    for (auto &element: elements) {
+        std::vector<int>().swap(element.nodes);
+        std::vector<int>().swap(element.faces);
+    }
+
+    _releasedBytes += before - FvmMeshStorage::ContainerMemoryBytes(*this);
+}
+
+void FvmMeshContainer::PrintMemoryReport() const {
+    const double cells = elementsNb > 0 ? elementsNb : 1.0;
+    const std::size_t structBytes = FvmMeshStorage::ContainerMemoryBytes(*this);
+    const std::size_t storageBytes = storage.MemoryBytes();
+    const std::size_t derivedBytes = faceCoefficients.MemoryBytes() + regionIndex.MemoryBytes() +
+                                     faceSplit.MemoryBytes();
+
+    const auto print = [cells](const char *name, const std::size_t bytes) {
+        PetscPrintf(PETSC_COMM_WORLD, "  %s%.1f MB (%.0f B/cell)\n", name, bytes / 1048576.0, bytes / cells);
+    };
+
+    PetscPrintf(PETSC_COMM_WORLD, "Mesh storage%s (excluding nodes):\n", _distributed ? " of rank 0" : "");
+    print("Face/Element structs: \t", structBytes);
+    if (_releasedBytes > 0)
+        print("  released lists: \t", _releasedBytes);
+    print("CSR/SoA storage: \t", storageBytes);
+    print("Coefficients/index: \t", derivedBytes);
+    print("Total: \t\t\t", structBytes + storageBytes + derivedBytes);
+}
+
 void FvmMeshContainer::ComputeMeshProperties() {
     tetrasNb = 0;
     hexasNb = 0;
@@ -492,23 +859,69 @@ void FvmMeshContainer::ComputeMeshProperties() {
         totalArea += patch.Aj;
     }
 
-    PetscPrintf(PETSC_COMM_WORLD, "\nFVM MESH PROPERTIES:\n");
+    // Rank-0 counts next to the totals of all ranks; shared processor faces are counted once
+    // in the totals. Nodes and patches are per rank only: shared ones cannot be told apart here.
+    enum { ELEMENTS, TETRAS, HEXAS, PRISMS, FACES, TRIS, QUADS, PROCESSOR_FACES, COUNTS };
+    std::array<int, COUNTS> local{elementsNb, tetrasNb, hexasNb, prismNb, facesNb, trisNb, quadsNb, 0};
+    std::array<int, COUNTS> global = local;
+    if (_distributed) {
+        int processorTris = 0, processorQuads = 0;
+        // Processor faces are interior to the global mesh
+        for (const int index: _processorFaces) {
+            totalArea -= faces[index].Aj;
+            processorTris += faces[index].type == ElementType::TRIANGLE;
+            processorQuads += faces[index].type == ElementType::QUADRANGLE;
+        }
+        local[PROCESSOR_FACES] = static_cast<int>(_processorFaces.size());
+
+        double localTotals[2] = {totalArea, totalVolume};
+        double globalTotals[2];
+        MPI_Allreduce(localTotals, globalTotals, 2, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+        totalArea = globalTotals[0];
+        totalVolume = globalTotals[1];
+
+        std::array<int, COUNTS + 2> localCounts{};
+        std::copy(local.begin(), local.end(), localCounts.begin());
+        localCounts[COUNTS] = processorTris;
+        localCounts[COUNTS + 1] = processorQuads;
+        std::array<int, COUNTS + 2> globalCounts{};
+        MPI_Allreduce(localCounts.data(), globalCounts.data(), COUNTS + 2, MPI_INT, MPI_SUM, PETSC_COMM_WORLD);
+        std::copy(globalCounts.begin(), globalCounts.begin() + COUNTS, global.begin());
+        global[FACES] -= global[PROCESSOR_FACES] / 2;
+        global[TRIS] -= globalCounts[COUNTS] / 2;
+        global[QUADS] -= globalCounts[COUNTS + 1] / 2;
+        global[PROCESSOR_FACES] /= 2;
+    }
+
+    const auto print = [this, &local, &global](const char *name, const int index) {
+        if (_distributed)
+            PetscPrintf(PETSC_COMM_WORLD, "  %s%d / %d\n", name, local[index], global[index]);
+        else
+            PetscPrintf(PETSC_COMM_WORLD, "  %s%d\n", name, local[index]);
+    };
+    const char *perRank = _distributed ? " (rank 0)" : "";
+
+    PetscPrintf(PETSC_COMM_WORLD, "\nFVM MESH PROPERTIES%s:\n", _distributed ? " (rank 0 / all ranks)" : "");
     PetscPrintf(PETSC_COMM_WORLD, "Total surface area: \t%.3E %s^2\n",
                 totalArea, fvmParameter.ulength.c_str());
     PetscPrintf(PETSC_COMM_WORLD, "Total volume: \t\t\t%.3E %s^3\n",
                 totalVolume, fvmParameter.ulength.c_str());
     PetscPrintf(PETSC_COMM_WORLD, "Mesh statistics:\n");
-    PetscPrintf(PETSC_COMM_WORLD, "  Nodes: \t\t\t\t%d\n", nodesNb);
-    PetscPrintf(PETSC_COMM_WORLD, "  Faces: \t\t\t\t%d\n", facesNb);
-    PetscPrintf(PETSC_COMM_WORLD, "  Patches: \t\t\t\t%d\n", patchesNb);
-    PetscPrintf(PETSC_COMM_WORLD, "  Elements: \t\t\t%d\n", elementsNb);
+    PetscPrintf(PETSC_COMM_WORLD, "  Nodes: \t\t\t\t%d%s\n", nodesNb, perRank);
+    print("Faces: \t\t\t\t", FACES);
+    if (_distributed)
+        print("Processor faces: \t\t", PROCESSOR_FACES);
+    PetscPrintf(PETSC_COMM_WORLD, "  Patches: \t\t\t\t%d%s\n", patchesNb, perRank);
+    print("Elements: \t\t\t", ELEMENTS);
 
     PetscPrintf(PETSC_COMM_WORLD, "Element types:\n");
-    PetscPrintf(PETSC_COMM_WORLD, "  Tetrahedrons: \t\t%d\n", tetrasNb);
-    PetscPrintf(PETSC_COMM_WORLD, "  Hexahedrons: \t\t\t%d\n", hexasNb);
-    PetscPrintf(PETSC_COMM_WORLD, "  Prisms: \t\t\t\t%d\n", prismNb);
-    PetscPrintf(PETSC_COMM_WORLD, "  Triangles: \t\t\t%d\n", trisNb);
-    PetscPrintf(PETSC_COMM_WORLD, "  Quadrangles: \t\t\t%d\n", quadsNb);
+    print("Tetrahedrons: \t\t", TETRAS);
+    print("Hexahedrons: \t\t\t", HEXAS);
+    print("Prisms: \t\t\t\t", PRISMS);
+    print("Triangles: \t\t\t", TRIS);
+    print("Quadrangles: \t\t\t", QUADS);
+
+    PrintMemoryReport();
 }
 
 int FvmMeshContainer::GetSurfacesRegionsNumber() const {
@@ -540,14 +953,14 @@ void FvmMeshContainer::ExportMeshToParallelizedVtk() const {
         auto points = vtkSmartPointer<vtkPoints>::New();
         std::map<int, vtkIdType> globalToLocalNodeId;
 
-        std::vector<const FvmMesh::Element *> elemsForProc;
-        for (const auto &elem: elements)
-            if (elem.procId == procId)
-                elemsForProc.push_back(&elem);
+        std::vector<int> elemsForProc;
+        for (int e = 0; e < elementsNb; ++e)
+            if (elements[e].procId == procId)
+                elemsForProc.push_back(e);
 
         std::set<int> neededNodes;
-        for (const auto *elem: elemsForProc)
-            for (int n: elem->nodes)
+        for (const int e: elemsForProc)
+            for (int n: storage.elementNodes.Row(e))
                 neededNodes.insert(n);
 
         vtkIdType localId = 0;
@@ -563,10 +976,10 @@ void FvmMeshContainer::ExportMeshToParallelizedVtk() const {
         procIdArray->SetName("procId");
         procIdArray->SetNumberOfComponents(1);
 
-        for (const auto *elem: elemsForProc) {
+        for (const int e: elemsForProc) {
+            const auto *elem = &elements[e];
             vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
-            for (int i = 0; i < elem->nodesNb; ++i) {
-                int globalNodeId = elem->nodes[i];
+            for (int globalNodeId: storage.elementNodes.Row(e)) {
                 auto it = globalToLocalNodeId.find(globalNodeId);
                 if (it == globalToLocalNodeId.end()) {
                     std::cerr << "Error: node not found in local map\n";
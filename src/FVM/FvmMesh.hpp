@@ -3,10 +3,16 @@
 
 #include "MeshObject.hpp"
 #include "BndCond.hpp"
+#include "FvmMeshStorage.hpp"
+#include "FvmFaceCoefficients.hpp"
+#include "FvmRegionIndex.hpp"
+#include "FvmFaceSplit.hpp"
 
 #include <vector>
 
 namespace FvmMesh {
+    struct LocalMeshData;
+
     enum class ElementType {
         UNKNOWN,
         BEAM,
@@ -99,6 +105,9 @@ class FvmMeshContainer {
 public:
     explicit FvmMeshContainer(const std::shared_ptr<MeshObject> &meshObject);
 
+    //! Builds the partition of one rank, with processor faces and ghosts
+    explicit FvmMeshContainer(const FvmMesh::LocalMeshData &localMesh);
+
     ~FvmMeshContainer() = default;
 
     [[nodiscard]] int GetSurfacesRegionsNumber() const;
@@ -112,20 +121,63 @@ public:
     void SetProcNumber(const int procNb) { _procNumber = procNb; }
     [[nodiscard]] int GetProcNumber() const { return _procNumber; }
     [[nodiscard]] bool IsParallel() const { return _procNumber > 1; };
+    [[nodiscard]] bool IsDistributed() const { return _distributed; }
+
+    //! Rank owning the cell with the given global ID
+    [[nodiscard]] int GetCellOwner(int globalIndex) const;
 
     void ExportMeshToParallelizedVtk() const;
 
 private:
+    friend class FvmMeshCache;
+
+    //! Empty container filled by FvmMeshCache::Load
+    FvmMeshContainer() = default;
+
     void BuildFvmMesh(const std::shared_ptr<MeshObject> &meshObject);
 
+    void BuildLocalFvmMesh(const FvmMesh::LocalMeshData &localMesh);
+
+    void RenumberMesh();
+
+    void SetProcessorPatches();
+
+    void SetSharedFaces();
+
     void ComputeFaces();
 
+    //! False when the face has a zero direction vector; safe to call from worker threads
+    bool ComputeFaceGeometry(FvmMesh::Face &face) const;
+
+    void ComputePatchGeometry(FvmMesh::Face &patch) const;
+
     void ComputeVolumes();
 
+    void ComputeElementGeometry(FvmMesh::Element &element) const;
+
     void ComputeMeshProperties();
 
+    //! CSR/SoA storage and the face coefficients, region index and face split built from it
+    void BuildStorage();
+
+    //! As BuildStorage, taking over connectivity already in CSR form (mesh cache)
+    void BuildStorage(FvmMesh::Csr elementNodes, FvmMesh::Csr elementFaces, FvmMesh::Csr faceNodes);
+
+    //! Frees the node and face lists of the Face/Element structs (patches keep theirs);
+    //! the CSR rows of storage replace them and BuildStorage cannot run again
+    void ReleaseConnectivity();
+
+    //! Heap footprint per cell of the structs and of the arrays built by BuildStorage
+    void PrintMemoryReport() const;
+
 private:
+    //! Face coefficients, region index and face split of a built storage; releases the struct lists
+    void BuildDerived();
+
     int _procNumber = 1;
+    bool _distributed = false;
+    std::vector<int> _processorFaces;
+    std::size_t _releasedBytes = 0; //! Node and face lists freed by ReleaseConnectivity
     std::map<int, std::string> _physicalSurfaceRegions;
     std::map<int, std::string> _physicalVolumeRegions;
 
@@ -154,6 +206,23 @@ public:
     int ghostsNb = 0;
     std::vector<int> ghosts;
 
+    int cellOffset = 0; //! Global ID of the first local cell
+    std::vector<int> cellOffsets; //! Global cell ranges of all ranks (distributed mesh)
+
+    /**
+     * Face ownership. A processor face is owned by the rank of its lower
+     * global cell ID; faces [0, ownedFacesNb) are owned and the shared
+     * copies of the others follow, with their global IDs in faceGhosts.
+     */
+    int ownedFacesNb = 0;
+    int faceOffset = 0; //! Global ID of the first owned face
+    std::vector<int> faceGhosts;
+
+    FvmMeshStorage storage; //! CSR/SoA copy of the mesh for streaming loops
+    FvmFaceCoefficients faceCoefficients; //! Interpolation and diffusion coefficients per face
+    FvmRegionIndex regionIndex; //! Faces and cells per physical region
+    FvmFaceSplit faceSplit; //! Interior and processor faces for OverlappedFaceLoop
+
     // bool nodCorrelationAllocated = false;
     // bool eleCorrelationAllocated = false;
 
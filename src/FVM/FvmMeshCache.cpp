@@ -0,0 +1,526 @@
+#include "FvmMeshCache.hpp"
+#include "FvmMesh.hpp"
+#include "FvmLog.hpp"
+#include "FvmParam.hpp"
+#include "MeshAlgorithm.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "petscsys.h"
+
+using namespace FvmMesh;
+
+namespace {
+    constexpr char MAGIC[8] = {'F', 'V', 'M', 'M', 'E', 'S', 'H', '\0'};
+    constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    constexpr std::size_t SECTION_ALIGNMENT = 8;
+
+    constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint64_t key;
+        std::uint32_t faceRecordSize;
+        std::uint32_t elementRecordSize;
+    };
+
+    // Fixed size Face/Element images; node and face lists are stored as CSR
+    struct FaceRecord {
+        std::int32_t index, type, nodesNb, owner, pair, physReg, procId, ghost, bc, padding;
+        Vector3 cVec, nVec, aVec, dVec, rpl, rnl;
+        double Aj, dj, kj;
+    };
+
+    struct ElementRecord {
+        std::int32_t index, type, nodesNb, facesNb, phyReg, procId, bc, padding;
+        Vector3 nVec, cVec;
+        double dp, Lp, Ap, Vp;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Vector3>);
+    static_assert(std::is_trivially_copyable_v<FaceRecord>);
+    static_assert(std::is_trivially_copyable_v<ElementRecord>);
+
+    std::uint64_t Fnv1a(std::uint64_t hash, const void *data, const std::size_t bytes) {
+        const auto *p = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < bytes; ++i) {
+            hash ^= p[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    template<typename T>
+    std::uint64_t Fnv1a(const std::uint64_t hash, const T &value) {
+        static_assert(std::is_arithmetic_v<T>);
+        return Fnv1a(hash, &value, sizeof(T));
+    }
+
+    //! Read-only mapping of a whole file, unmapped on destruction
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string &path) {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+
+            struct stat st{};
+            if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED) {
+                    _data = static_cast<const char *>(addr);
+                    _size = static_cast<std::size_t>(st.st_size);
+                }
+            }
+            close(fd);
+        }
+
+        ~MappedFile() {
+            if (_data)
+                munmap(const_cast<char *>(_data), _size);
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        [[nodiscard]] const char *Data() const { return _data; }
+        [[nodiscard]] std::size_t Size() const { return _size; }
+
+    private:
+        const char *_data = nullptr;
+        std::size_t _size = 0;
+    };
+
+    //! Sections are a 64-bit element count followed by the raw elements,
+    //! padded to 8 bytes
+    class SectionWriter {
+    public:
+        explicit SectionWriter(std::ofstream &os) : _os(os) {
+        }
+
+        template<typename T>
+        void Write(const T *data, const std::size_t count) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const std::uint64_t n = count;
+            _os.write(reinterpret_cast<const char *>(&n), sizeof(n));
+
+            const std::size_t bytes = count * sizeof(T);
+            if (bytes > 0)
+                _os.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+
+            static constexpr char zeros[SECTION_ALIGNMENT] = {};
+            const std::size_t pad = (SECTION_ALIGNMENT - bytes % SECTION_ALIGNMENT) % SECTION_ALIGNMENT;
+            _os.write(zeros, static_cast<std::streamsize>(pad));
+        }
+
+        template<typename T>
+        void Write(const std::vector<T> &v) { Write(v.data(), v.size()); }
+
+    private:
+        std::ofstream &_os;
+    };
+
+    //! Reads the sections of a mapped file straight into their containers
+    //! (one copy from the page cache, no stream buffer in between)
+    class SectionReader {
+    public:
+        explicit SectionReader(const MappedFile &file, const std::size_t offset)
+            : _data(file.Data()), _size(file.Size()), _pos(offset) {
+        }
+
+        template<typename T>
+        bool Read(std::vector<T> &v) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            std::uint64_t n;
+            if (_size - _pos < sizeof(n))
+                return false;
+            std::memcpy(&n, _data + _pos, sizeof(n));
+            _pos += sizeof(n);
+
+            if (n > (_size - _pos) / sizeof(T))
+                return false;
+
+            const std::size_t bytes = n * sizeof(T);
+            v.resize(n);
+            if (bytes > 0)
+                std::memcpy(v.data(), _data + _pos, bytes);
+
+            _pos += bytes + (SECTION_ALIGNMENT - bytes % SECTION_ALIGNMENT) % SECTION_ALIGNMENT;
+            _pos = std::min(_pos, _size);
+            return true;
+        }
+
+    private:
+        const char *_data;
+        std::size_t _size;
+        std::size_t _pos;
+    };
+
+    FaceRecord ToRecord(const Face &face) {
+        FaceRecord r{};
+        r.index = face.index;
+        r.type = static_cast<std::int32_t>(face.type);
+        r.nodesNb = face.nodesNb;
+        r.owner = face.owner;
+        r.pair = face.pair;
+        r.physReg = face.physReg;
+        r.procId = face.procId;
+        r.ghost = face.ghost;
+        r.bc = static_cast<std::int32_t>(face.bc);
+        r.cVec = face.cVec;
+        r.nVec = face.nVec;
+        r.aVec = face.aVec;
+        r.dVec = face.dVec;
+        r.rpl = face.rpl;
+        r.rnl = face.rnl;
+        r.Aj = face.Aj;
+        r.dj = face.dj;
+        r.kj = face.kj;
+        return r;
+    }
+
+    Face FromRecord(const FaceRecord &r) {
+        Face face;
+        face.index = r.index;
+        face.type = static_cast<ElementType>(r.type);
+        face.nodesNb = r.nodesNb;
+        face.owner = r.owner;
+        face.pair = r.pair;
+        face.physReg = r.physReg;
+        face.procId = r.procId;
+        face.ghost = r.ghost;
+        face.bc = static_cast<BndCondType>(r.bc);
+        face.cVec = r.cVec;
+        face.nVec = r.nVec;
+        face.aVec = r.aVec;
+        face.dVec = r.dVec;
+        face.rpl = r.rpl;
+        face.rnl = r.rnl;
+        face.Aj = r.Aj;
+        face.dj = r.dj;
+        face.kj = r.kj;
+        return face;
+    }
+
+    ElementRecord ToRecord(const Element &element) {
+        ElementRecord r{};
+        r.index = element.index;
+        r.type = static_cast<std::int32_t>(element.type);
+        r.nodesNb = element.nodesNb;
+        r.facesNb = element.facesNb;
+        r.phyReg = element.phyReg;
+        r.procId = element.procId;
+        r.bc = static_cast<std::int32_t>(element.bc);
+        r.nVec = element.nVec;
+        r.cVec = element.cVec;
+        r.dp = element.dp;
+        r.Lp = element.Lp;
+        r.Ap = element.Ap;
+        r.Vp = element.Vp;
+        return r;
+    }
+
+    Element FromRecord(const ElementRecord &r) {
+        Element element;
+        element.index = r.index;
+        element.type = static_cast<ElementType>(r.type);
+        element.nodesNb = r.nodesNb;
+        element.facesNb = r.facesNb;
+        element.phyReg = r.phyReg;
+        element.procId = r.procId;
+        element.bc = static_cast<BndCondType>(r.bc);
+        element.nVec = r.nVec;
+        element.cVec = r.cVec;
+        element.dp = r.dp;
+        element.Lp = r.Lp;
+        element.Ap = r.Ap;
+        element.Vp = r.Vp;
+        return element;
+    }
+
+    //! Records of the faces with their node rows
+    void WriteFaces(SectionWriter &writer, const std::vector<Face> &faces, const Csr &nodes) {
+        std::vector<FaceRecord> records;
+        records.reserve(faces.size());
+        for (const auto &face: faces)
+            records.push_back(ToRecord(face));
+
+        writer.Write(records);
+        writer.Write(nodes.offsets);
+        writer.Write(nodes.indices);
+    }
+
+    //! Patches keep their node lists in the structs
+    void WriteFaces(SectionWriter &writer, const std::vector<Face> &faces) {
+        Csr nodes;
+        for (const auto &face: faces) {
+            nodes.indices.insert(nodes.indices.end(), face.nodes.begin(), face.nodes.end());
+            nodes.offsets.push_back(static_cast<int>(nodes.indices.size()));
+        }
+        WriteFaces(writer, faces, nodes);
+    }
+
+    //! Rows from 0, non-decreasing offsets ending at the index count, indices in [lower, upper)
+    bool ReadCsr(SectionReader &reader, Csr &csr, const std::size_t rows, const int lower, const int upper) {
+        if (!reader.Read(csr.offsets) || !reader.Read(csr.indices) || csr.offsets.size() != rows + 1 ||
+            csr.offsets.front() != 0 || csr.offsets.back() != static_cast<int>(csr.indices.size()))
+            return false;
+
+        for (std::size_t i = 0; i < rows; ++i) {
+            if (csr.offsets[i + 1] < csr.offsets[i])
+                return false;
+        }
+
+        return std::all_of(csr.indices.begin(), csr.indices.end(),
+                           [lower, upper](const int index) { return index >= lower && index < upper; });
+    }
+
+    //! Face nodes are 1-based indices into nodesNb nodes; they stay in CSR form
+    bool ReadFaces(SectionReader &reader, std::vector<Face> &faces, Csr &nodes, const int nodesNb) {
+        std::vector<FaceRecord> records;
+        if (!reader.Read(records) || !ReadCsr(reader, nodes, records.size(), 1, nodesNb + 1))
+            return false;
+
+        faces.clear();
+        faces.reserve(records.size());
+        for (const auto &record: records)
+            faces.push_back(FromRecord(record));
+        return true;
+    }
+
+    //! Patches get their node lists back in the structs
+    bool ReadFaces(SectionReader &reader, std::vector<Face> &faces, const int nodesNb) {
+        Csr nodes;
+        if (!ReadFaces(reader, faces, nodes, nodesNb))
+            return false;
+
+        for (std::size_t i = 0; i < faces.size(); ++i) {
+            const auto row = nodes.Row(static_cast<int>(i));
+            faces[i].nodes.assign(row.begin(), row.end());
+        }
+        return true;
+    }
+
+    std::vector<char> PackRegions(const std::map<int, std::string> &regions) {
+        std::ostringstream os;
+        for (const auto &[index, label]: regions)
+            os << index << '\t' << label << '\n';
+        const std::string packed = os.str();
+        return {packed.begin(), packed.end()};
+    }
+
+    std::map<int, std::string> UnpackRegions(const std::vector<char> &packed) {
+        std::map<int, std::string> regions;
+        std::istringstream is(std::string(packed.begin(), packed.end()));
+        int index;
+        std::string label;
+        while (is >> index && is.get() == '\t' && std::getline(is, label))
+            regions[index] = label;
+        return regions;
+    }
+}
+
+std::uint64_t FvmMeshCache::ComputeKey(
+    const std::string &stepFile, const MeshAlgorithm &meshAlgorithm, const int processorsNb) {
+    std::uint64_t hash = FNV_OFFSET;
+    hash = Fnv1a(hash, VERSION);
+
+    const MappedFile step(stepFile);
+    if (step.Data())
+        hash = Fnv1a(hash, step.Data(), step.Size());
+
+    const auto &a = meshAlgorithm;
+    hash = Fnv1a(hash, static_cast<int>(a.fineness));
+    hash = Fnv1a(hash, a.secondOrder);
+    hash = Fnv1a(hash, a.quadAllowed);
+    hash = Fnv1a(hash, a.maxSize);
+    hash = Fnv1a(hash, a.minSize);
+    hash = Fnv1a(hash, a.growthRate);
+    hash = Fnv1a(hash, a.meshSizeFile.data(), a.meshSizeFile.size());
+    hash = Fnv1a(hash, a.nbSegPerRadius);
+    hash = Fnv1a(hash, a.nbSegPerEdge);
+    hash = Fnv1a(hash, a.optimize);
+    hash = Fnv1a(hash, a.nbSurfOptSteps);
+    hash = Fnv1a(hash, a.nbVolOptSteps);
+    hash = Fnv1a(hash, a.elemSizeWeight);
+    hash = Fnv1a(hash, a.worstElemMeasure);
+    hash = Fnv1a(hash, a.surfaceCurvature);
+    hash = Fnv1a(hash, a.useDelauney);
+    hash = Fnv1a(hash, a.checkOverlapping);
+    hash = Fnv1a(hash, a.checkChartBoundary);
+    hash = Fnv1a(hash, a.GetDim());
+
+    hash = Fnv1a(hash, processorsNb);
+    hash = Fnv1a(hash, fvmParameter.renumber);
+
+    return hash;
+}
+
+std::string FvmMeshCache::CachePath(const std::string &cacheDir, const std::uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "fvmMesh-%016llx.bin", static_cast<unsigned long long>(key));
+    return cacheDir.empty() ? std::string(name) : cacheDir + "/" + name;
+}
+
+bool FvmMeshCache::Save(const FvmMeshContainer &mesh, const std::string &path, const std::uint64_t key) {
+    PetscLogEventBegin(FvmLog::Event("FvmMeshCacheSave"), 0, 0, 0, 0);
+
+    const std::string tmpPath = path + ".tmp";
+    std::ofstream os(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!os) {
+        PetscLogEventEnd(FvmLog::Event("FvmMeshCacheSave"), 0, 0, 0, 0);
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.key = key;
+    header.faceRecordSize = sizeof(FaceRecord);
+    header.elementRecordSize = sizeof(ElementRecord);
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    SectionWriter writer(os);
+
+    const std::vector<std::int32_t> counts = {
+        mesh._procNumber, mesh._distributed ? 1 : 0,
+        mesh.nodesNb, mesh.facesNb, mesh.elementsNb, mesh.patchesNb, mesh.outPatchesNb,
+        mesh.trisNb, mesh.quadsNb, mesh.tetrasNb, mesh.hexasNb, mesh.prismNb,
+        mesh.ghostsNb, mesh.cellOffset, mesh.ownedFacesNb, mesh.faceOffset
+    };
+    const std::vector<double> totals = {mesh.totalVolume, mesh.totalArea};
+    writer.Write(counts);
+    writer.Write(totals);
+
+    writer.Write(mesh.nodes);
+    WriteFaces(writer, mesh.faces, mesh.storage.faceNodes);
+    WriteFaces(writer, mesh.patches);
+
+    std::vector<ElementRecord> elements;
+    elements.reserve(mesh.elements.size());
+    for (const auto &element: mesh.elements)
+        elements.push_back(ToRecord(element));
+    writer.Write(elements);
+    writer.Write(mesh.storage.elementNodes.offsets);
+    writer.Write(mesh.storage.elementNodes.indices);
+    writer.Write(mesh.storage.elementFaces.offsets);
+    writer.Write(mesh.storage.elementFaces.indices);
+
+    writer.Write(mesh.ghosts);
+    writer.Write(mesh.cellOffsets);
+    writer.Write(mesh.faceGhosts);
+    writer.Write(mesh._processorFaces);
+    writer.Write(PackRegions(mesh._physicalSurfaceRegions));
+    writer.Write(PackRegions(mesh._physicalVolumeRegions));
+
+    os.close();
+    const bool saved = !os.fail() && std::rename(tmpPath.c_str(), path.c_str()) == 0;
+    if (!saved)
+        std::remove(tmpPath.c_str());
+
+    PetscLogEventEnd(FvmLog::Event("FvmMeshCacheSave"), 0, 0, 0, 0);
+    return saved;
+}
+
+std::shared_ptr<FvmMeshContainer> FvmMeshCache::Load(const std::string &path, const std::uint64_t key) {
+    const MappedFile file(path);
+    if (!file.Data() || file.Size() < sizeof(Header))
+        return nullptr;
+
+    Header header{};
+    std::memcpy(&header, file.Data(), sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK || header.key != key ||
+        header.faceRecordSize != sizeof(FaceRecord) || header.elementRecordSize != sizeof(ElementRecord))
+        return nullptr;
+
+    PetscLogEventBegin(FvmLog::Event("FvmMeshCacheLoad"), 0, 0, 0, 0);
+
+    std::shared_ptr<FvmMeshContainer> mesh(new FvmMeshContainer());
+    SectionReader reader(file, sizeof(Header));
+
+    std::vector<std::int32_t> counts;
+    std::vector<double> totals;
+    std::vector<ElementRecord> elements;
+    Csr faceNodes, elementNodes, elementFaces;
+    std::vector<char> surfaceRegions, volumeRegions;
+
+    bool valid = reader.Read(counts) && counts.size() == 16 && reader.Read(totals) && totals.size() == 2 &&
+                 reader.Read(mesh->nodes) &&
+                 ReadFaces(reader, mesh->faces, faceNodes, static_cast<int>(mesh->nodes.size())) &&
+                 ReadFaces(reader, mesh->patches, static_cast<int>(mesh->nodes.size())) &&
+                 reader.Read(elements) &&
+                 ReadCsr(reader, elementNodes, elements.size(), 1, static_cast<int>(mesh->nodes.size()) + 1) &&
+                 ReadCsr(reader, elementFaces, elements.size(), 0, static_cast<int>(mesh->faces.size())) &&
+                 reader.Read(mesh->ghosts) &&
+                 reader.Read(mesh->cellOffsets) &&
+                 reader.Read(mesh->faceGhosts) &&
+                 reader.Read(mesh->_processorFaces) &&
+                 reader.Read(surfaceRegions) &&
+                 reader.Read(volumeRegions);
+
+    if (valid) {
+        mesh->_procNumber = counts[0];
+        mesh->_distributed = counts[1] != 0;
+        mesh->nodesNb = counts[2];
+        mesh->facesNb = counts[3];
+        mesh->elementsNb = counts[4];
+        mesh->patchesNb = counts[5];
+        mesh->outPatchesNb = counts[6];
+        mesh->trisNb = counts[7];
+        mesh->quadsNb = counts[8];
+        mesh->tetrasNb = counts[9];
+        mesh->hexasNb = counts[10];
+        mesh->prismNb = counts[11];
+        mesh->ghostsNb = counts[12];
+        mesh->cellOffset = counts[13];
+        mesh->ownedFacesNb = counts[14];
+        mesh->faceOffset = counts[15];
+        mesh->totalVolume = totals[0];
+        mesh->totalArea = totals[1];
+
+        valid = mesh->nodesNb == static_cast<int>(mesh->nodes.size()) &&
+                mesh->facesNb == static_cast<int>(mesh->faces.size()) &&
+                mesh->patchesNb == static_cast<int>(mesh->patches.size()) &&
+                mesh->elementsNb == static_cast<int>(elements.size());
+
+        // Cell references of the faces index the elements directly
+        const int elementsNb = mesh->elementsNb;
+        valid = valid && std::all_of(mesh->faces.begin(), mesh->faces.end(), [elementsNb](const Face &face) {
+            return face.owner >= 0 && face.owner < elementsNb && face.pair >= -1 && face.pair < elementsNb;
+        });
+    }
+
+    if (valid) {
+        mesh->elements.reserve(elements.size());
+        for (const auto &record: elements)
+            mesh->elements.push_back(FromRecord(record));
+
+        mesh->_physicalSurfaceRegions = UnpackRegions(surfaceRegions);
+        mesh->_physicalVolumeRegions = UnpackRegions(volumeRegions);
+
+        // The connectivity read above becomes the storage CSR as is
+        mesh->BuildStorage(std::move(elementNodes), std::move(elementFaces), std::move(faceNodes));
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmMeshCacheLoad"), 0, 0, 0, 0);
+
+    return valid ? mesh : nullptr;
+}
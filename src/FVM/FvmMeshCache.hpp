@@ -0,0 +1,40 @@
+#ifndef FVMMESHCACHE_HPP
+#define FVMMESHCACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class FvmMeshContainer;
+class MeshAlgorithm;
+
+/**
+ * Versioned binary on-disk copy of a built FvmMeshContainer (nodes, faces,
+ * patches, elements, region maps, partition ids and computed geometry).
+ * Files are named after a key hashed from the STEP file contents, the
+ * meshing parameters, the partition count and the cell renumbering. Load
+ * maps the file and copies each section once into its container, checked
+ * (sizes, CSR offsets and index ranges) before the mesh is used; the CSR
+ * connectivity is handed to FvmMeshStorage as read instead of being
+ * rebuilt from the structs.
+ */
+class FvmMeshCache {
+public:
+    //! Bump when the file layout or the records change
+    static constexpr std::uint32_t VERSION = 2;
+
+    //! FNV-1a hash of the STEP file, the MeshAlgorithm settings, processorsNb and the cell renumbering
+    static std::uint64_t ComputeKey(
+        const std::string &stepFile, const MeshAlgorithm &meshAlgorithm, int processorsNb);
+
+    //! <cacheDir>/fvmMesh-<key>.bin
+    static std::string CachePath(const std::string &cacheDir, std::uint64_t key);
+
+    //! Writes the container atomically (temporary file + rename). Returns false on I/O failure.
+    static bool Save(const FvmMeshContainer &mesh, const std::string &path, std::uint64_t key);
+
+    //! Returns nullptr if the file is missing, truncated or written for another key/version
+    static std::shared_ptr<FvmMeshContainer> Load(const std::string &path, std::uint64_t key);
+};
+
+#endif
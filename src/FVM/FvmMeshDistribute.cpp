@@ -0,0 +1,443 @@
+#include "FvmMeshDistribute.hpp"
+#include "Globals.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+
+#include "petscsys.h"
+
+using namespace FvmMesh;
+
+namespace {
+    constexpr int TAG_SIZES = 401;
+    constexpr int TAG_INTS = 402;
+    constexpr int TAG_DOUBLES = 403;
+
+    constexpr int HEADER_SIZE = 5; // cells, nodes, surface elements, cell offset, face descriptors
+    constexpr int KEY_RECORD = MAX_FACE_NODES + 1; // sorted global nodes + owner cell
+
+    struct PartitionBuffers {
+        std::vector<int> ints;
+        std::vector<double> doubles;
+    };
+
+    int PartitionRank(const MeshObject &mesh, const int element, const int size) {
+        if (size == 1 || mesh.GetProcNumber() <= 1)
+            return 0;
+
+        return mesh.vol_partition[element] - 1;
+    }
+
+    // Surface elements (0-based) of every partition: those with all their nodes
+    // on cells of the partition. One pass over the cells lists the partitions of
+    // each node (ascending, as a CSR); one pass over the surface elements
+    // intersects the lists of their nodes.
+    std::vector<std::vector<int> > BucketSurfaceElements(
+        const MeshObject &mesh, const std::vector<std::vector<int> > &partitionCells) {
+        const int nodesNb = static_cast<int>(mesh.GetNP()) + 1;
+        const int partitionsNb = static_cast<int>(partitionCells.size());
+
+        std::vector<int> offsets(nodesNb + 1, 0);
+        std::vector<int> mark(nodesNb, -1);
+        for (int r = 0; r < partitionsNb; ++r) {
+            for (const int e: partitionCells[r]) {
+                for (const int v: mesh.VolumeElement(e + 1).Vertices()) {
+                    if (mark[v] != r) {
+                        mark[v] = r;
+                        ++offsets[v + 1];
+                    }
+                }
+            }
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<int> partitions(offsets.back());
+        std::vector<int> next(offsets.begin(), offsets.end() - 1);
+        std::fill(mark.begin(), mark.end(), -1);
+        for (int r = 0; r < partitionsNb; ++r) {
+            for (const int e: partitionCells[r]) {
+                for (const int v: mesh.VolumeElement(e + 1).Vertices()) {
+                    if (mark[v] != r) {
+                        mark[v] = r;
+                        partitions[next[v]++] = r;
+                    }
+                }
+            }
+        }
+
+        std::vector<std::vector<int> > surfaces(partitionsNb);
+        const int surfElementsNb = static_cast<int>(mesh.GetNSE());
+        std::vector<int> verts;
+        for (int s = 0; s < surfElementsNb; ++s) {
+            verts.clear();
+            for (const int v: mesh.SurfaceElement(s + 1).Vertices())
+                verts.push_back(v);
+            if (verts.empty())
+                continue;
+
+            // Candidates are the partitions of the first node
+            for (int k = offsets[verts[0]]; k < offsets[verts[0] + 1]; ++k) {
+                const int r = partitions[k];
+                const bool local = std::all_of(verts.begin() + 1, verts.end(), [&](const int v) {
+                    return std::binary_search(partitions.begin() + offsets[v], partitions.begin() + offsets[v + 1], r);
+                });
+                if (local)
+                    surfaces[r].push_back(s);
+            }
+        }
+        return surfaces;
+    }
+
+    // Packs the cells of one partition with the nodes they touch and the surface
+    // elements of BucketSurfaceElements. nodeLocal (size NP + 1, filled with -1)
+    // is restored on exit.
+    PartitionBuffers PackPartition(
+        const MeshObject &mesh, const std::vector<int> &cells, const std::vector<int> &surfaces,
+        const int cellOffset, std::vector<int> &nodeLocal) {
+        PartitionBuffers buffers;
+        auto &ints = buffers.ints;
+        ints.assign(HEADER_SIZE, 0);
+
+        std::vector<int> nodeGlobal;
+        for (const int e: cells) {
+            const auto &elem = mesh.VolumeElement(e + 1);
+            const auto &verts = elem.Vertices();
+
+            ints.push_back(elem.GetType());
+            ints.push_back(elem.GetIndex());
+            ints.push_back(elem.GetNFaces());
+            ints.push_back(static_cast<int>(verts.size()));
+            for (const int v: verts) {
+                if (nodeLocal[v] == -1) {
+                    nodeGlobal.push_back(v);
+                    nodeLocal[v] = static_cast<int>(nodeGlobal.size());
+                }
+                ints.push_back(nodeLocal[v]);
+            }
+        }
+
+        for (const int s: surfaces) {
+            const auto &se = mesh.SurfaceElement(s + 1);
+            const auto &verts = se.Vertices();
+
+            ints.push_back(se.GetIndex());
+            ints.push_back(mesh.GetProcNumber() > 1 ? mesh.surf_partition[s] : 1);
+            ints.push_back(static_cast<int>(verts.size()));
+            for (const int v: verts)
+                ints.push_back(nodeLocal[v]);
+        }
+
+        ints.insert(ints.end(), nodeGlobal.begin(), nodeGlobal.end());
+
+        buffers.doubles.reserve(3 * nodeGlobal.size());
+        for (const int v: nodeGlobal) {
+            const auto &p = mesh.Point(v);
+            buffers.doubles.push_back(p(0));
+            buffers.doubles.push_back(p(1));
+            buffers.doubles.push_back(p(2));
+            nodeLocal[v] = -1;
+        }
+
+        ints[0] = static_cast<int>(cells.size());
+        ints[1] = static_cast<int>(nodeGlobal.size());
+        ints[2] = static_cast<int>(surfaces.size());
+        ints[3] = cellOffset;
+        ints[4] = mesh.GetNFD();
+
+        return buffers;
+    }
+
+    void UnpackPartition(const PartitionBuffers &buffers, LocalMeshData &local) {
+        const auto &ints = buffers.ints;
+        const int cellsNb = ints[0];
+        const int nodesNb = ints[1];
+        const int surfNb = ints[2];
+        local.cellOffset = ints[3];
+        local.surfaceDescriptorsNb = ints[4];
+
+        std::size_t pos = HEADER_SIZE;
+
+        local.cellTypes.resize(cellsNb);
+        local.cellRegions.resize(cellsNb);
+        local.cellFacesNb.resize(cellsNb);
+        local.cellNodes.offsets.assign(1, 0);
+        local.cellNodes.indices.clear();
+        for (int c = 0; c < cellsNb; ++c) {
+            local.cellTypes[c] = ints[pos++];
+            local.cellRegions[c] = ints[pos++];
+            local.cellFacesNb[c] = ints[pos++];
+            const int np = ints[pos++];
+            local.cellNodes.indices.insert(local.cellNodes.indices.end(), ints.data() + pos, ints.data() + pos + np);
+            local.cellNodes.offsets.push_back(static_cast<int>(local.cellNodes.indices.size()));
+            pos += np;
+        }
+
+        local.surfRegions.resize(surfNb);
+        local.surfPartitions.resize(surfNb);
+        local.surfNodes.offsets.assign(1, 0);
+        local.surfNodes.indices.clear();
+        for (int s = 0; s < surfNb; ++s) {
+            local.surfRegions[s] = ints[pos++];
+            local.surfPartitions[s] = ints[pos++];
+            const int np = ints[pos++];
+            local.surfNodes.indices.insert(local.surfNodes.indices.end(), ints.data() + pos, ints.data() + pos + np);
+            local.surfNodes.offsets.push_back(static_cast<int>(local.surfNodes.indices.size()));
+            pos += np;
+        }
+
+        local.nodeGlobalIds.assign(ints.data() + pos, ints.data() + pos + nodesNb);
+
+        local.nodes.resize(nodesNb);
+        for (int n = 0; n < nodesNb; ++n) {
+            local.nodes[n] = {buffers.doubles[3 * n], buffers.doubles[3 * n + 1], buffers.doubles[3 * n + 2]};
+        }
+    }
+
+    void BroadcastRegions(std::map<int, std::string> &regions, const MPI_Comm comm) {
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+
+        std::string packed;
+        if (rank == 0) {
+            std::ostringstream os;
+            for (const auto &[index, label]: regions)
+                os << index << '\t' << label << '\n';
+            packed = os.str();
+        }
+
+        int length = static_cast<int>(packed.size());
+        MPI_Bcast(&length, 1, MPI_INT, 0, comm);
+        packed.resize(length);
+        MPI_Bcast(packed.data(), length, MPI_CHAR, 0, comm);
+
+        if (rank != 0) {
+            regions.clear();
+            std::istringstream is(packed);
+            int index;
+            std::string label;
+            while (is >> index && is.get() == '\t' && std::getline(is, label))
+                regions[index] = label;
+        }
+    }
+}
+
+LocalMeshData FvmMesh::ScatterMeshPartitions(const std::shared_ptr<MeshObject> &meshObject, const MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    PetscPrintf(comm, "\nDistributing mesh partitions...\n");
+
+    LocalMeshData local;
+    local.rank = rank;
+
+    // Validate on rank 0 and broadcast the verdict, so that no rank is left
+    // waiting in a collective call
+    int status = LOGICAL_TRUE;
+    std::vector<int> cellsPerRank(size, 0);
+    std::vector<std::vector<int> > partitionCells;
+    if (rank == 0) {
+        if (!meshObject || meshObject->GetNE() == 0) {
+            status = LOGICAL_ERROR;
+        } else if (meshObject->GetProcNumber() > 1 && meshObject->GetProcNumber() != size) {
+            status = LOGICAL_ERROR;
+        } else {
+            partitionCells.resize(size);
+            const int elementsNb = static_cast<int>(meshObject->GetNE());
+            for (int e = 0; e < elementsNb; ++e) {
+                const int owner = PartitionRank(*meshObject, e, size);
+                if (owner < 0 || owner >= size) {
+                    status = LOGICAL_ERROR;
+                    break;
+                }
+                partitionCells[owner].push_back(e);
+            }
+            for (int r = 0; r < size; ++r)
+                cellsPerRank[r] = static_cast<int>(partitionCells[r].size());
+        }
+    }
+
+    MPI_Bcast(&status, 1, MPI_INT, 0, comm);
+    if (status == LOGICAL_ERROR) {
+        throw FvmException(
+            "Mesh distribution requires a volume mesh decomposed into one partition per rank",
+            LOGICAL_ERROR);
+    }
+
+    MPI_Bcast(cellsPerRank.data(), size, MPI_INT, 0, comm);
+    local.cellOffsets.assign(size + 1, 0);
+    std::partial_sum(cellsPerRank.begin(), cellsPerRank.end(), local.cellOffsets.begin() + 1);
+
+    PartitionBuffers buffers;
+    if (rank == 0) {
+        std::vector<int> nodeLocal(meshObject->GetNP() + 1, -1);
+        auto partitionSurfaces = BucketSurfaceElements(*meshObject, partitionCells);
+
+        for (int r = 1; r < size; ++r) {
+            const auto remote = PackPartition(*meshObject, partitionCells[r], partitionSurfaces[r],
+                                              local.cellOffsets[r], nodeLocal);
+            partitionCells[r].clear();
+            partitionCells[r].shrink_to_fit();
+            partitionSurfaces[r].clear();
+            partitionSurfaces[r].shrink_to_fit();
+
+            const std::array<int, 2> sizes{
+                static_cast<int>(remote.ints.size()), static_cast<int>(remote.doubles.size())
+            };
+            MPI_Send(sizes.data(), 2, MPI_INT, r, TAG_SIZES, comm);
+            MPI_Send(remote.ints.data(), sizes[0], MPI_INT, r, TAG_INTS, comm);
+            MPI_Send(remote.doubles.data(), sizes[1], MPI_DOUBLE, r, TAG_DOUBLES, comm);
+        }
+
+        buffers = PackPartition(*meshObject, partitionCells[0], partitionSurfaces[0], 0, nodeLocal);
+        local.surfaceRegions = meshObject->GetSurfaceRegions();
+        local.volumeRegions = meshObject->GetVolumeRegions();
+    } else {
+        std::array<int, 2> sizes{};
+        MPI_Recv(sizes.data(), 2, MPI_INT, 0, TAG_SIZES, comm, MPI_STATUS_IGNORE);
+        buffers.ints.resize(sizes[0]);
+        buffers.doubles.resize(sizes[1]);
+        MPI_Recv(buffers.ints.data(), sizes[0], MPI_INT, 0, TAG_INTS, comm, MPI_STATUS_IGNORE);
+        MPI_Recv(buffers.doubles.data(), sizes[1], MPI_DOUBLE, 0, TAG_DOUBLES, comm, MPI_STATUS_IGNORE);
+    }
+
+    UnpackPartition(buffers, local);
+
+    BroadcastRegions(local.surfaceRegions, comm);
+    BroadcastRegions(local.volumeRegions, comm);
+
+    return local;
+}
+
+std::vector<int> FvmMesh::ExchangeInterfaceFaces(
+    const std::vector<FaceKey> &keys, const std::vector<int> &cellGids, const MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    const int keysNb = static_cast<int>(keys.size());
+
+    // Bucket the keys by rendezvous rank
+    std::vector<int> destination(keysNb);
+    std::vector<int> sendCounts(size, 0);
+    for (int i = 0; i < keysNb; ++i) {
+        destination[i] = static_cast<int>(HashFaceKey(keys[i]) % static_cast<std::uint64_t>(size));
+        ++sendCounts[destination[i]];
+    }
+
+    std::vector<int> sendDispls(size + 1, 0);
+    std::partial_sum(sendCounts.begin(), sendCounts.end(), sendDispls.begin() + 1);
+
+    std::vector<int> order(keysNb);
+    {
+        std::vector<int> next(sendDispls.begin(), sendDispls.end() - 1);
+        for (int i = 0; i < keysNb; ++i)
+            order[next[destination[i]]++] = i;
+    }
+
+    std::vector<int> sendBuffer(static_cast<std::size_t>(keysNb) * KEY_RECORD);
+    for (int j = 0; j < keysNb; ++j) {
+        const int i = order[j];
+        std::copy(keys[i].v.begin(), keys[i].v.end(), &sendBuffer[j * KEY_RECORD]);
+        sendBuffer[j * KEY_RECORD + MAX_FACE_NODES] = cellGids[i];
+    }
+
+    std::vector<int> recvCounts(size);
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm);
+
+    std::vector<int> recvDispls(size + 1, 0);
+    std::partial_sum(recvCounts.begin(), recvCounts.end(), recvDispls.begin() + 1);
+    const int recvNb = recvDispls[size];
+
+    auto scaled = [](const std::vector<int> &v, const int factor) {
+        std::vector<int> out(v.size());
+        std::transform(v.begin(), v.end(), out.begin(), [factor](const int x) { return x * factor; });
+        return out;
+    };
+
+    std::vector<int> recvBuffer(static_cast<std::size_t>(recvNb) * KEY_RECORD);
+    MPI_Alltoallv(sendBuffer.data(), scaled(sendCounts, KEY_RECORD).data(), scaled(sendDispls, KEY_RECORD).data(),
+                  MPI_INT, recvBuffer.data(), scaled(recvCounts, KEY_RECORD).data(),
+                  scaled(recvDispls, KEY_RECORD).data(), MPI_INT, comm);
+
+    // Pair identical keys received from different ranks
+    std::vector<FaceKey> recvKeys(recvNb);
+    for (int i = 0; i < recvNb; ++i)
+        std::copy_n(&recvBuffer[i * KEY_RECORD], MAX_FACE_NODES, recvKeys[i].v.begin());
+
+    std::vector<int> replyBuffer(recvNb, -1);
+    FaceHashMap rendezvous(recvNb);
+    for (int i = 0; i < recvNb; ++i) {
+        auto [first, inserted] = rendezvous.TryEmplace(recvKeys[i], i);
+        if (!inserted) {
+            replyBuffer[i] = recvBuffer[first * KEY_RECORD + MAX_FACE_NODES];
+            replyBuffer[first] = recvBuffer[i * KEY_RECORD + MAX_FACE_NODES];
+        }
+    }
+
+    std::vector<int> replies(keysNb);
+    MPI_Alltoallv(replyBuffer.data(), recvCounts.data(), recvDispls.data(), MPI_INT,
+                  replies.data(), sendCounts.data(), sendDispls.data(), MPI_INT, comm);
+
+    std::vector<int> neighbours(keysNb);
+    for (int j = 0; j < keysNb; ++j)
+        neighbours[order[j]] = replies[j];
+
+    return neighbours;
+}
+
+std::vector<int> FvmMesh::ExchangeSharedFaceIds(
+    const std::vector<SharedFace> &owned, const std::vector<SharedFace> &shared, const MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    constexpr int RECORD = 3; // low cell, high cell, global face ID
+
+    std::vector<int> sendCounts(size, 0);
+    for (const auto &face: owned)
+        sendCounts[face.rank] += RECORD;
+
+    std::vector<int> sendDispls(size + 1, 0);
+    std::partial_sum(sendCounts.begin(), sendCounts.end(), sendDispls.begin() + 1);
+
+    std::vector<int> sendBuffer(sendDispls[size]);
+    {
+        std::vector<int> next(sendDispls.begin(), sendDispls.end() - 1);
+        for (const auto &face: owned) {
+            int *record = &sendBuffer[next[face.rank]];
+            record[0] = face.lowCell;
+            record[1] = face.highCell;
+            record[2] = face.globalId;
+            next[face.rank] += RECORD;
+        }
+    }
+
+    std::vector<int> recvCounts(size);
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm);
+
+    std::vector<int> recvDispls(size + 1, 0);
+    std::partial_sum(recvCounts.begin(), recvCounts.end(), recvDispls.begin() + 1);
+
+    std::vector<int> recvBuffer(recvDispls[size]);
+    MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendDispls.data(), MPI_INT,
+                  recvBuffer.data(), recvCounts.data(), recvDispls.data(), MPI_INT, comm);
+
+    std::map<std::pair<int, int>, int> globalIds;
+    for (std::size_t i = 0; i < recvBuffer.size(); i += RECORD)
+        globalIds.emplace(std::make_pair(recvBuffer[i], recvBuffer[i + 1]), recvBuffer[i + 2]);
+
+    std::vector<int> ids;
+    ids.reserve(shared.size());
+    for (const auto &face: shared) {
+        const auto it = globalIds.find({face.lowCell, face.highCell});
+        if (it == globalIds.end()) {
+            std::ostringstream msg;
+            msg << "Shared face between cells " << face.lowCell << " and " << face.highCell
+                    << " has no owner on rank " << face.rank;
+            throw FvmException(msg.str(), LOGICAL_ERROR);
+        }
+        ids.push_back(it->second);
+    }
+
+    return ids;
+}
@@ -0,0 +1,76 @@
+#ifndef FVMMESHDISTRIBUTE_HPP
+#define FVMMESHDISTRIBUTE_HPP
+
+#include "FvmFaceMap.hpp"
+#include "FvmMesh.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+namespace FvmMesh {
+    //! Cells of one partition as received by its owning rank. Node ids in
+    //! cellNodes/surfNodes are local and 1-based, like Netgen point ids.
+    struct LocalMeshData {
+        int rank = 0;
+        int cellOffset = 0; //! Global ID of the first local cell
+        std::vector<int> cellOffsets; //! Global cell ranges of all ranks (size + 1)
+        int surfaceDescriptorsNb = 0; //! Netgen face descriptors (volume region offset)
+
+        std::vector<int> nodeGlobalIds; //! Local node -> global (Netgen) node ID
+        std::vector<Vector3> nodes;
+
+        std::vector<int> cellTypes; //! Netgen element types
+        std::vector<int> cellRegions;
+        std::vector<int> cellFacesNb;
+        Csr cellNodes;
+
+        std::vector<int> surfRegions;
+        std::vector<int> surfPartitions;
+        Csr surfNodes;
+
+        std::map<int, std::string> surfaceRegions;
+        std::map<int, std::string> volumeRegions;
+
+        [[nodiscard]] int CellsNumber() const { return static_cast<int>(cellTypes.size()); }
+    };
+
+    /**
+     * Sends the cells of every partition of a decomposed Netgen mesh from
+     * rank 0 to their owning ranks. meshObject is only read on rank 0.
+     * Partition p (vol_partition == p + 1) goes to rank p; an undecomposed
+     * mesh stays on rank 0. Collective on comm.
+     */
+    LocalMeshData ScatterMeshPartitions(const std::shared_ptr<MeshObject> &meshObject, MPI_Comm comm);
+
+    /**
+     * Matches faces left unpaired by the local face build across ranks.
+     * keys hold global node IDs, cellGids the global owner cell IDs.
+     * Returns the global ID of the neighbour cell, or -1 if no other rank
+     * holds the face. Faces meet at a rendezvous rank chosen by key hash,
+     * so no rank needs the global face list. Collective on comm.
+     */
+    std::vector<int> ExchangeInterfaceFaces(
+        const std::vector<FaceKey> &keys, const std::vector<int> &cellGids, MPI_Comm comm);
+
+    //! Processor face seen from one side: the rank across it and its two cells
+    struct SharedFace {
+        int rank = -1;
+        int lowCell = -1; //! Lower global cell ID (owning side)
+        int highCell = -1;
+        int globalId = -1;
+    };
+
+    /**
+     * Sends the global IDs of owned processor faces to the ranks holding
+     * their shared copies. Returns the global ID of every face in shared,
+     * matched by its (lowCell, highCell) pair. Collective on comm.
+     */
+    std::vector<int> ExchangeSharedFaceIds(
+        const std::vector<SharedFace> &owned, const std::vector<SharedFace> &shared, MPI_Comm comm);
+}
+
+#endif
@@ -0,0 +1,329 @@
+#include "FvmMeshRenumber.hpp"
+#include "FvmMesh.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <tuple>
+
+using namespace FvmMesh;
+
+namespace {
+    constexpr int HILBERT_BITS = 21; // per axis, 63 bit keys
+
+    //! Cell adjacency through interior faces
+    Csr BuildCellGraph(const FvmMeshContainer &mesh) {
+        const int cellsNb = mesh.elementsNb;
+
+        Csr graph;
+        graph.offsets.assign(cellsNb + 1, 0);
+        for (const auto &face: mesh.faces) {
+            if (face.pair == -1)
+                continue;
+            ++graph.offsets[face.owner + 1];
+            ++graph.offsets[face.pair + 1];
+        }
+        std::partial_sum(graph.offsets.begin(), graph.offsets.end(), graph.offsets.begin());
+
+        graph.indices.resize(graph.offsets.back());
+        std::vector<int> next(graph.offsets.begin(), graph.offsets.end() - 1);
+        for (const auto &face: mesh.faces) {
+            if (face.pair == -1)
+                continue;
+            graph.indices[next[face.owner]++] = face.pair;
+            graph.indices[next[face.pair]++] = face.owner;
+        }
+
+        return graph;
+    }
+
+    //! Breadth-first level structure from root; returns the cells of the last level
+    std::vector<int> LastLevel(const Csr &graph, const int root, std::vector<int> &level, int &depth) {
+        std::fill(level.begin(), level.end(), -1);
+
+        std::vector<int> front{root}, next;
+        level[root] = 0;
+        depth = 0;
+        while (true) {
+            next.clear();
+            for (const int c: front) {
+                for (const int n: graph.Row(c)) {
+                    if (level[n] == -1) {
+                        level[n] = depth + 1;
+                        next.push_back(n);
+                    }
+                }
+            }
+            if (next.empty())
+                return front;
+            front.swap(next);
+            ++depth;
+        }
+    }
+
+    //! Pseudo-peripheral start cell of the component containing root
+    //! (George-Liu: restart from a minimum degree cell of the last level
+    //! while the eccentricity grows)
+    int PeripheralCell(const Csr &graph, int root, std::vector<int> &level) {
+        auto degree = [&graph](const int c) { return static_cast<int>(graph.Row(c).size()); };
+
+        int depth;
+        auto last = LastLevel(graph, root, level, depth);
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            const int candidate = *std::min_element(last.begin(), last.end(), [&degree](const int a, const int b) {
+                return degree(a) < degree(b);
+            });
+
+            int candidateDepth;
+            auto candidateLast = LastLevel(graph, candidate, level, candidateDepth);
+            if (candidateDepth <= depth)
+                break;
+
+            root = candidate;
+            depth = candidateDepth;
+            last.swap(candidateLast);
+        }
+
+        return root;
+    }
+
+    std::vector<int> ReverseCuthillMcKee(const FvmMeshContainer &mesh) {
+        const int cellsNb = mesh.elementsNb;
+        const Csr graph = BuildCellGraph(mesh);
+        auto degree = [&graph](const int c) { return static_cast<int>(graph.Row(c).size()); };
+
+        // Components are started from their lowest degree cell
+        std::vector<int> byDegree(cellsNb);
+        std::iota(byDegree.begin(), byDegree.end(), 0);
+        std::stable_sort(byDegree.begin(), byDegree.end(), [&degree](const int a, const int b) {
+            return degree(a) < degree(b);
+        });
+
+        std::vector<int> order;
+        order.reserve(cellsNb);
+        std::vector<char> visited(cellsNb, 0);
+        std::vector<int> level(cellsNb, -1);
+        std::vector<int> neighbours;
+
+        for (const int seed: byDegree) {
+            if (visited[seed])
+                continue;
+
+            const int start = PeripheralCell(graph, seed, level);
+            std::size_t head = order.size();
+            order.push_back(start);
+            visited[start] = 1;
+
+            while (head < order.size()) {
+                const int c = order[head++];
+
+                neighbours.clear();
+                for (const int n: graph.Row(c)) {
+                    if (!visited[n]) {
+                        visited[n] = 1;
+                        neighbours.push_back(n);
+                    }
+                }
+                std::stable_sort(neighbours.begin(), neighbours.end(), [&degree](const int a, const int b) {
+                    return degree(a) < degree(b);
+                });
+                order.insert(order.end(), neighbours.begin(), neighbours.end());
+            }
+        }
+
+        std::vector<int> permutation(cellsNb);
+        for (int i = 0; i < cellsNb; ++i)
+            permutation[order[i]] = cellsNb - 1 - i;
+
+        return permutation;
+    }
+
+    //! Skilling's transform of axis coordinates into the transposed Hilbert index
+    std::uint64_t HilbertKey(std::uint32_t x[3]) {
+        constexpr std::uint32_t M = 1u << (HILBERT_BITS - 1);
+
+        for (std::uint32_t q = M; q > 1; q >>= 1) {
+            const std::uint32_t p = q - 1;
+            for (int i = 0; i < 3; ++i) {
+                if (x[i] & q) {
+                    x[0] ^= p;
+                } else {
+                    const std::uint32_t t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t;
+                    x[i] ^= t;
+                }
+            }
+        }
+
+        for (int i = 1; i < 3; ++i)
+            x[i] ^= x[i - 1];
+
+        std::uint32_t t = 0;
+        for (std::uint32_t q = M; q > 1; q >>= 1) {
+            if (x[2] & q)
+                t ^= q - 1;
+        }
+        for (int i = 0; i < 3; ++i)
+            x[i] ^= t;
+
+        std::uint64_t key = 0;
+        for (int bit = HILBERT_BITS - 1; bit >= 0; --bit) {
+            for (int i = 0; i < 3; ++i)
+                key = (key << 1) | ((x[i] >> bit) & 1u);
+        }
+        return key;
+    }
+
+    std::vector<int> HilbertOrdering(const FvmMeshContainer &mesh) {
+        const int cellsNb = mesh.elementsNb;
+
+        // Vertex averages; the centroids are not computed yet
+        std::vector<Vector3> centres(cellsNb);
+        Vector3 lo{1e300, 1e300, 1e300}, hi{-1e300, -1e300, -1e300};
+        for (int c = 0; c < cellsNb; ++c) {
+            Vector3 centre;
+            for (const int n: mesh.elements[c].nodes) {
+                const Vector3 &p = mesh.nodes[n - 1];
+                centre.x += p.x;
+                centre.y += p.y;
+                centre.z += p.z;
+            }
+            const double inv = 1.0 / std::max(1, mesh.elements[c].nodesNb);
+            centre = {centre.x * inv, centre.y * inv, centre.z * inv};
+            centres[c] = centre;
+
+            lo = {std::min(lo.x, centre.x), std::min(lo.y, centre.y), std::min(lo.z, centre.z)};
+            hi = {std::max(hi.x, centre.x), std::max(hi.y, centre.y), std::max(hi.z, centre.z)};
+        }
+
+        // Common scale for all axes keeps the curve isotropic
+        const double extent = std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z, 1e-300});
+        const double scale = ((1u << HILBERT_BITS) - 1) / extent;
+
+        std::vector<std::uint64_t> keys(cellsNb);
+        for (int c = 0; c < cellsNb; ++c) {
+            std::uint32_t x[3] = {
+                static_cast<std::uint32_t>((centres[c].x - lo.x) * scale),
+                static_cast<std::uint32_t>((centres[c].y - lo.y) * scale),
+                static_cast<std::uint32_t>((centres[c].z - lo.z) * scale)
+            };
+            keys[c] = HilbertKey(x);
+        }
+
+        std::vector<int> order(cellsNb);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&keys](const int a, const int b) {
+            return keys[a] < keys[b];
+        });
+
+        std::vector<int> permutation(cellsNb);
+        for (int i = 0; i < cellsNb; ++i)
+            permutation[order[i]] = i;
+
+        return permutation;
+    }
+}
+
+MatrixProfile FvmMesh::ComputeMatrixProfile(const FvmMeshContainer &mesh) {
+    MatrixProfile result;
+
+    // First column of every row of the lower triangle
+    std::vector<int> rowStart(mesh.elementsNb);
+    std::iota(rowStart.begin(), rowStart.end(), 0);
+
+    for (const auto &face: mesh.faces) {
+        if (face.pair == -1)
+            continue;
+
+        const int lo = std::min(face.owner, face.pair);
+        const int hi = std::max(face.owner, face.pair);
+        result.bandwidth = std::max(result.bandwidth, hi - lo);
+        rowStart[hi] = std::min(rowStart[hi], lo);
+    }
+
+    for (int i = 0; i < mesh.elementsNb; ++i)
+        result.profile += i - rowStart[i];
+
+    return result;
+}
+
+std::vector<int> FvmMesh::ComputeCellOrdering(const FvmMeshContainer &mesh, const CellOrdering ordering) {
+    switch (ordering) {
+        case CellOrdering::RCM:
+            return ReverseCuthillMcKee(mesh);
+        case CellOrdering::HILBERT:
+            return HilbertOrdering(mesh);
+        default: {
+            std::vector<int> identity(mesh.elementsNb);
+            std::iota(identity.begin(), identity.end(), 0);
+            return identity;
+        }
+    }
+}
+
+void FvmMesh::ApplyCellOrdering(FvmMeshContainer &mesh, const std::vector<int> &cellPermutation) {
+    // CELLS
+    std::vector<Element> elements(mesh.elements.size());
+    for (std::size_t c = 0; c < mesh.elements.size(); ++c) {
+        const int target = cellPermutation[c];
+        elements[target] = std::move(mesh.elements[c]);
+        elements[target].index = target;
+    }
+    mesh.elements.swap(elements);
+
+    // FACES
+    for (auto &face: mesh.faces) {
+        face.owner = cellPermutation[face.owner];
+        if (face.pair != -1) {
+            face.pair = cellPermutation[face.pair];
+            // Normals are oriented towards the pair when the geometry is computed
+            if (face.owner > face.pair)
+                std::swap(face.owner, face.pair);
+        }
+    }
+
+    std::vector<int> order(mesh.faces.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&mesh](const int a, const int b) {
+        const Face &fa = mesh.faces[a];
+        const Face &fb = mesh.faces[b];
+        const bool boundaryA = fa.pair == -1;
+        const bool boundaryB = fb.pair == -1;
+        if (boundaryA != boundaryB)
+            return boundaryB;
+        if (boundaryA)
+            return std::tie(fa.physReg, fa.owner) < std::tie(fb.physReg, fb.owner);
+        return std::tie(fa.owner, fa.pair) < std::tie(fb.owner, fb.pair);
+    });
+
+    for (auto &patch: mesh.patches)
+        patch.owner = cellPermutation[patch.owner];
+
+    PermuteFaces(mesh, order);
+}
+
+void FvmMesh::PermuteFaces(FvmMeshContainer &mesh, const std::vector<int> &order) {
+    std::vector<int> faceIndex(mesh.faces.size());
+    std::vector<Face> faces(mesh.faces.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        faceIndex[order[i]] = static_cast<int>(i);
+        faces[i] = std::move(mesh.faces[order[i]]);
+        faces[i].index = static_cast<int>(i);
+    }
+    mesh.faces.swap(faces);
+
+    for (auto &element: mesh.elements) {
+        for (auto &face: element.faces) {
+            if (face != -1)
+                face = faceIndex[face];
+        }
+    }
+
+    // PATCHES (copies of the boundary faces, kept in face order)
+    for (auto &patch: mesh.patches)
+        patch.index = faceIndex[patch.index];
+
+    std::sort(mesh.patches.begin(), mesh.patches.end(), [](const Face &a, const Face &b) {
+        return a.index < b.index;
+    });
+}
@@ -0,0 +1,38 @@
+#ifndef FVMMESHRENUMBER_HPP
+#define FVMMESHRENUMBER_HPP
+
+#include <vector>
+
+class FvmMeshContainer;
+
+namespace FvmMesh {
+    enum class CellOrdering {
+        NATIVE = 0, //! Netgen order
+        RCM = 1, //! Reverse Cuthill-McKee on the face graph
+        HILBERT = 2 //! Hilbert curve through the cell centres
+    };
+
+    //! Bandwidth and profile (envelope size) of the cell adjacency matrix
+    struct MatrixProfile {
+        int bandwidth = 0;
+        long long profile = 0;
+    };
+
+    MatrixProfile ComputeMatrixProfile(const FvmMeshContainer &mesh);
+
+    //! Returns the new ID of every cell (old -> new)
+    std::vector<int> ComputeCellOrdering(const FvmMeshContainer &mesh, CellOrdering ordering);
+
+    /**
+     * Renumbers cells with the given permutation and re-sorts faces: interior
+     * faces by (owner, pair) with owner < pair, then boundary faces grouped
+     * by physical region and sorted by owner. Element face lists and patches
+     * follow. Must run before the geometry is computed.
+     */
+    void ApplyCellOrdering(FvmMeshContainer &mesh, const std::vector<int> &cellPermutation);
+
+    //! Reorders faces (order[new] = old), remapping element face lists and patches
+    void PermuteFaces(FvmMeshContainer &mesh, const std::vector<int> &order);
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "FvmMeshStorage.hpp"
+#include "FvmMesh.hpp"
+
+#include <utility>
+
+using namespace FvmMesh;
+
+namespace {
+    // Typical allocator bookkeeping per heap block
+    constexpr std::size_t HEAP_BLOCK_OVERHEAD = 16;
+
+    template<typename T>
+    std::size_t HeapVectorBytes(const std::vector<T> &v) {
+        return v.capacity() == 0 ? 0 : VectorBytes(v) + HEAP_BLOCK_OVERHEAD;
+    }
+
+    std::size_t FaceBytes(const std::vector<Face> &faces) {
+        std::size_t bytes = VectorBytes(faces);
+        for (const auto &face: faces)
+            bytes += HeapVectorBytes(face.nodes);
+        return bytes;
+    }
+
+    template<typename Item, typename Get>
+    void AppendRows(Csr &csr, const std::vector<Item> &items, Get get) {
+        csr.offsets.assign(1, 0);
+        csr.offsets.reserve(items.size() + 1);
+        csr.indices.clear();
+
+        std::size_t total = 0;
+        for (const auto &item: items)
+            total += get(item).size();
+        csr.indices.reserve(total);
+
+        for (const auto &item: items) {
+            const auto &row = get(item);
+            csr.indices.insert(csr.indices.end(), row.begin(), row.end());
+            csr.offsets.push_back(static_cast<int>(csr.indices.size()));
+        }
+    }
+}
+
+std::size_t Csr::MemoryBytes() const {
+    return VectorBytes(offsets) + VectorBytes(indices);
+}
+
+void FvmMeshStorage::Build(const FvmMeshContainer &mesh) {
+    AppendRows(elementNodes, mesh.elements, [](const Element &e) -> const std::vector<int> &{ return e.nodes; });
+    AppendRows(elementFaces, mesh.elements, [](const Element &e) -> const std::vector<int> &{ return e.faces; });
+    AppendRows(faceNodes, mesh.faces, [](const Face &f) -> const std::vector<int> &{ return f.nodes; });
+
+    BuildArrays(mesh);
+}
+
+void FvmMeshStorage::Build(const FvmMeshContainer &mesh, Csr elementNodes, Csr elementFaces, Csr faceNodes) {
+    this->elementNodes = std::move(elementNodes);
+    this->elementFaces = std::move(elementFaces);
+    this->faceNodes = std::move(faceNodes);
+
+    BuildArrays(mesh);
+}
+
+void FvmMeshStorage::BuildArrays(const FvmMeshContainer &mesh) {
+    const std::size_t facesNb = mesh.faces.size();
+    owner.resize(facesNb);
+    pair.resize(facesNb);
+    Aj.resize(facesNb);
+    nx.resize(facesNb);
+    ny.resize(facesNb);
+    nz.resize(facesNb);
+    fcx.resize(facesNb);
+    fcy.resize(facesNb);
+    fcz.resize(facesNb);
+    bc.resize(facesNb);
+
+    for (std::size_t i = 0; i < facesNb; ++i) {
+        const Face &face = mesh.faces[i];
+        owner[i] = face.owner;
+        pair[i] = face.pair;
+        Aj[i] = face.Aj;
+        nx[i] = face.nVec.x;
+        ny[i] = face.nVec.y;
+        nz[i] = face.nVec.z;
+        fcx[i] = face.cVec.x;
+        fcy[i] = face.cVec.y;
+        fcz[i] = face.cVec.z;
+        bc[i] = face.bc;
+    }
+
+    const std::size_t elementsNb = mesh.elements.size();
+    Vp.resize(elementsNb);
+    ecx.resize(elementsNb);
+    ecy.resize(elementsNb);
+    ecz.resize(elementsNb);
+
+    for (std::size_t i = 0; i < elementsNb; ++i) {
+        const Element &element = mesh.elements[i];
+        Vp[i] = element.Vp;
+        ecx[i] = element.cVec.x;
+        ecy[i] = element.cVec.y;
+        ecz[i] = element.cVec.z;
+    }
+
+    UpdateGhosts(mesh);
+}
+
+void FvmMeshStorage::UpdateGhosts(const FvmMeshContainer &mesh) {
+    const std::size_t facesNb = mesh.faces.size();
+    ghost.assign(facesNb, -1);
+
+    for (std::size_t i = 0; i < facesNb; ++i) {
+        const Face &face = mesh.faces[i];
+        if (face.pair == -1 && face.bc == BndCondType::PROCESSOR)
+            ghost[i] = face.ghost;
+    }
+}
+
+FaceView FvmMeshStorage::Faces() const {
+    FaceView view;
+    view.size = static_cast<int>(owner.size());
+    view.owner = owner;
+    view.pair = pair;
+    view.Aj = Aj;
+    view.nx = nx;
+    view.ny = ny;
+    view.nz = nz;
+    view.cx = fcx;
+    view.cy = fcy;
+    view.cz = fcz;
+    view.ghost = ghost;
+    view.bc = bc;
+    return view;
+}
+
+ElementView FvmMeshStorage::Elements() const {
+    ElementView view;
+    view.size = static_cast<int>(Vp.size());
+    view.Vp = Vp;
+    view.cx = ecx;
+    view.cy = ecy;
+    view.cz = ecz;
+    return view;
+}
+
+std::size_t FvmMeshStorage::MemoryBytes() const {
+    return elementNodes.MemoryBytes() + elementFaces.MemoryBytes() + faceNodes.MemoryBytes() +
+           VectorBytes(owner) + VectorBytes(pair) + VectorBytes(Aj) +
+           VectorBytes(nx) + VectorBytes(ny) + VectorBytes(nz) +
+           VectorBytes(fcx) + VectorBytes(fcy) + VectorBytes(fcz) +
+           VectorBytes(ghost) + VectorBytes(bc) +
+           VectorBytes(Vp) + VectorBytes(ecx) + VectorBytes(ecy) + VectorBytes(ecz);
+}
+
+std::size_t FvmMeshStorage::ContainerMemoryBytes(const FvmMeshContainer &mesh) {
+    std::size_t bytes = FaceBytes(mesh.faces) + FaceBytes(mesh.patches);
+
+    bytes += VectorBytes(mesh.elements);
+    for (const auto &element: mesh.elements)
+        bytes += HeapVectorBytes(element.nodes) + HeapVectorBytes(element.faces);
+
+    return bytes;
+}
@@ -0,0 +1,139 @@
+#ifndef FVMMESHSTORAGE_HPP
+#define FVMMESHSTORAGE_HPP
+
+#include <cstddef>
+#include <new>
+#include <span>
+#include <vector>
+
+#include "BndCond.hpp"
+
+class FvmMeshContainer;
+
+namespace FvmMesh {
+    //! Allocator starting every array on a cache line, for the streaming face loops
+    template<typename T>
+    struct AlignedAllocator {
+        using value_type = T;
+        static constexpr std::align_val_t alignment{64};
+
+        AlignedAllocator() = default;
+
+        template<typename U>
+        explicit AlignedAllocator(const AlignedAllocator<U> &) noexcept {
+        }
+
+        [[nodiscard]] T *allocate(const std::size_t n) {
+            return static_cast<T *>(::operator new(n * sizeof(T), alignment));
+        }
+
+        void deallocate(T *p, std::size_t) noexcept {
+            ::operator delete(p, alignment);
+        }
+
+        template<typename U>
+        bool operator==(const AlignedAllocator<U> &) const noexcept { return true; }
+    };
+
+    template<typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T> >;
+
+    //! Heap bytes reserved by a vector
+    template<typename T, typename Allocator>
+    std::size_t VectorBytes(const std::vector<T, Allocator> &v) {
+        return v.capacity() * sizeof(T);
+    }
+
+    //! Compressed sparse row index lists: row i is
+    //! indices[offsets[i]] ... indices[offsets[i + 1] - 1]
+    struct Csr {
+        std::vector<int> offsets{0};
+        std::vector<int> indices;
+
+        [[nodiscard]] int Size() const { return static_cast<int>(offsets.size()) - 1; }
+
+        [[nodiscard]] std::span<const int> Row(const int i) const {
+            return {indices.data() + offsets[i], indices.data() + offsets[i + 1]};
+        }
+
+        [[nodiscard]] std::size_t MemoryBytes() const;
+    };
+
+    //! Read-only contiguous face arrays (structure of arrays)
+    struct FaceView {
+        int size = 0;
+
+        std::span<const int> owner; //! Owner cell ID
+        std::span<const int> pair; //! Neighbour cell ID (-1 on boundary)
+
+        std::span<const double> Aj; //! Surface area
+        std::span<const double> nx, ny, nz; //! Unit normal
+        std::span<const double> cx, cy, cz; //! Centroid
+
+        std::span<const int> ghost; //! Ghost slot of processor faces, -1 otherwise
+        std::span<const BndCondType> bc; //! Boundary condition code (NONE inside)
+    };
+
+    //! Read-only contiguous cell arrays (structure of arrays)
+    struct ElementView {
+        int size = 0;
+
+        std::span<const double> Vp; //! Volume
+        std::span<const double> cx, cy, cz; //! Centroid
+    };
+}
+
+/**
+ * Compact copy of the FVM mesh: CSR connectivity and SoA geometry. Face
+ * and cell loops stream these arrays instead of walking the per-object
+ * Face/Element structs. The structs keep the scalar geometry (cache,
+ * renumbering); their node and face lists are released once the storage
+ * is built unless fvmParameter.keepconn is set, which leaves the CSR rows
+ * as the only connectivity. Rebuild after the mesh is modified.
+ */
+class FvmMeshStorage {
+public:
+    FvmMeshStorage() = default;
+
+    void Build(const FvmMeshContainer &mesh);
+
+    //! Takes over connectivity that is already in CSR form (mesh cache) and
+    //! fills the SoA arrays from the structs
+    void Build(const FvmMeshContainer &mesh, FvmMesh::Csr elementNodes, FvmMesh::Csr elementFaces,
+               FvmMesh::Csr faceNodes);
+
+    //! Ghost slots of the processor faces; run again when they change
+    void UpdateGhosts(const FvmMeshContainer &mesh);
+
+    [[nodiscard]] FvmMesh::FaceView Faces() const;
+
+    [[nodiscard]] FvmMesh::ElementView Elements() const;
+
+    [[nodiscard]] std::size_t MemoryBytes() const;
+
+    //! Heap footprint of the Face/Element/patch structs of the container
+    static std::size_t ContainerMemoryBytes(const FvmMeshContainer &mesh);
+
+private:
+    void BuildArrays(const FvmMeshContainer &mesh);
+
+public:
+    FvmMesh::Csr elementNodes;
+    FvmMesh::Csr elementFaces;
+    FvmMesh::Csr faceNodes;
+
+    // Faces
+    std::vector<int> owner;
+    std::vector<int> pair;
+    std::vector<double> Aj;
+    std::vector<double> nx, ny, nz;
+    std::vector<double> fcx, fcy, fcz;
+    std::vector<int> ghost;
+    std::vector<BndCondType> bc; //! Kept in step with Face::bc by FvmSetup::SetBoundary
+
+    // Elements
+    std::vector<double> Vp;
+    std::vector<double> ecx, ecy, ecz;
+};
+
+#endif
@@ -104,10 +104,12 @@ vtkSmartPointer<vtkUnstructuredGrid> FvmMeshToVtk::ConvertFvmInternalMeshToVtk()
         points->InsertNextPoint(v.x, v.y, v.z);
 
     vtkMesh->SetPoints(points);
-    for (const auto &elem: _fvmMesh->elements) {
+    for (int e = 0; e < _fvmMesh->elementsNb; ++e) {
+        const auto &elem = _fvmMesh->elements[e];
         vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
 
-        for (const int nodeId: elem.nodes) {
+        // Node lists live in the CSR storage once the structs release theirs
+        for (const int nodeId: _fvmMesh->storage.elementNodes.Row(e)) {
             ids->InsertNextId(nodeId - 1);
         }
 
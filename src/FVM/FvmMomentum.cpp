@@ -0,0 +1,178 @@
+#include "FvmMomentum.hpp"
+#include "FvmMesh.hpp"
+#include "FvmVar.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmLog.hpp"
+#include "FvmParam.hpp"
+#include "FvmFlowFaces.hpp"
+
+using namespace FvmMesh;
+using namespace FvmFlow;
+
+namespace {
+    constexpr int U = ToInt(FieldIndex::U);
+    constexpr int V = ToInt(FieldIndex::V);
+    constexpr int W = ToInt(FieldIndex::W);
+}
+
+FvmMomentum::FvmMomentum(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar,
+                         const FvmGradient &gradient)
+    : _fvmMesh(fvmMesh),
+      _fvmVar(fvmVar),
+      _gradient(gradient),
+      _steady(fvmParameter.steady == LOGICAL_TRUE) {
+    const int facesNb = _fvmMesh->storage.Faces().size;
+    _ownerCoefficients.resize(facesNb);
+    _neighbourCoefficients.resize(facesNb);
+
+    for (const int c: {U, V, W}) {
+        if (fvmParameter.calc[c] && fvmParameter.scheme[c] != static_cast<int>(FvmConvection::Scheme::UPWIND))
+            _deferredCorrection = fvmParameter.inertia == LOGICAL_TRUE;
+    }
+    if (_deferredCorrection)
+        _massFlux.resize(facesNb);
+}
+
+FvmMomentum::~FvmMomentum() {
+    for (auto &gradient: _gradU) {
+        if (gradient)
+            VecDestroy(&gradient);
+    }
+}
+
+void FvmMomentum::Assemble(const double dt) {
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+    const auto elements = _fvmMesh->storage.Elements();
+
+    // One matrix for the three components: they share ef[U]
+    const double alpha = _steady ? fvmParameter.ef[U] : 1.0;
+    const bool convection = fvmParameter.inertia == LOGICAL_TRUE;
+
+    {
+        const GhostedFieldRead dens(_fvmVar->dens), visc(_fvmVar->visc);
+        const GhostedFieldRead uf(_fvmVar->uf);
+        const GhostedFieldRead xuf(_fvmVar->xuf), xvf(_fvmVar->xvf), xwf(_fvmVar->xwf);
+        const FieldRead xu(_fvmVar->xu), xv(_fvmVar->xv), xw(_fvmVar->xw);
+        const FieldRead xu0(_fvmVar->xu0), xv0(_fvmVar->xv0), xw0(_fvmVar->xw0);
+        const FieldWrite bu(_fvmVar->bu), bv(_fvmVar->bv), bw(_fvmVar->bw), ap(_fvmVar->ap);
+
+        for (int i = 0; i < elementsNb; ++i) {
+            ap[i] = 0.0;
+            bu[i] = 0.0;
+            bv[i] = 0.0;
+            bw[i] = 0.0;
+        }
+
+        for (int i = 0; i < faces.size; ++i) {
+            const int owner = faces.owner[i];
+            const int neighbour = Neighbour(faces, i);
+
+            if (neighbour != -1) {
+                const double lambda = coefficients.lambda[i];
+                const double F = convection
+                                     ? Interpolate(dens, owner, neighbour, lambda) * uf[i] * faces.Aj[i]
+                                     : 0.0;
+                const double D = Interpolate(visc, owner, neighbour, lambda) * coefficients.diffusion[i];
+
+                if (_deferredCorrection)
+                    _massFlux[i] = F;
+
+                // Implicit upwind convection and central diffusion
+                ap[owner] += LMAX(F, 0.0) + D;
+                _ownerCoefficients[i] = LMIN(F, 0.0) - D;
+
+                if (neighbour < elementsNb) {
+                    ap[neighbour] += LMAX(-F, 0.0) + D;
+                    _neighbourCoefficients[i] = -LMAX(F, 0.0) - D;
+                }
+                continue;
+            }
+
+            // The schemes only correct faces between two cells
+            if (_deferredCorrection)
+                _massFlux[i] = 0.0;
+
+            const BoundaryKind kind = GetBoundaryKind(faces.bc[i]);
+            if (kind == BoundaryKind::NO_FLUX)
+                continue;
+
+            const double F = convection ? dens[owner] * uf[i] * faces.Aj[i] : 0.0;
+
+            // Inflow carries the boundary value in
+            double coefficient = -LMIN(F, 0.0);
+            ap[owner] += LMAX(F, 0.0);
+
+            if (kind == BoundaryKind::VELOCITY) {
+                const double D = visc[owner] * coefficients.diffusion[i];
+                ap[owner] += D;
+                coefficient += D;
+            }
+
+            bu[owner] += coefficient * xuf[i];
+            bv[owner] += coefficient * xvf[i];
+            bw[owner] += coefficient * xwf[i];
+        }
+
+        for (int i = 0; i < elementsNb; ++i) {
+            const double Vp = elements.Vp[i];
+
+            if (!_steady) {
+                const double inertia = dens[i] * Vp / dt;
+                ap[i] += inertia;
+                bu[i] += inertia * xu0[i];
+                bv[i] += inertia * xv0[i];
+                bw[i] += inertia * xw0[i];
+            }
+
+            bu[i] += dens[i] * fvmParameter.g[0] * Vp;
+            bv[i] += dens[i] * fvmParameter.g[1] * Vp;
+            bw[i] += dens[i] * fvmParameter.g[2] * Vp;
+
+            // Under-relaxation: aP / ef with the previous value as source
+            const double relaxation = ap[i] / alpha - ap[i];
+            bu[i] += relaxation * xu[i];
+            bv[i] += relaxation * xv[i];
+            bw[i] += relaxation * xw[i];
+            ap[i] += relaxation;
+        }
+    }
+
+    if (_deferredCorrection)
+        AddConvectionCorrection();
+}
+
+void FvmMomentum::AddConvectionCorrection() {
+    PetscLogEventBegin(FvmLog::Event("FvmConvection"), 0, 0, 0, 0);
+
+    // Created on first use: the owning solver validates the flow fields after its members
+    if (!_gradU[0]) {
+        for (auto &gradient: _gradU)
+            VecDuplicate(_fvmVar->xu, &gradient);
+    }
+
+    // One gradient sweep for the three components
+    const std::array<Vec, 3> x{_fvmVar->xu, _fvmVar->xv, _fvmVar->xw};
+    const std::array<Vec, 3> b{_fvmVar->bu, _fvmVar->bv, _fvmVar->bw};
+    std::vector<FvmGradientField> fields;
+    for (int c = 0; c < 3; ++c)
+        fields.push_back({x[c], nullptr, nullptr, {_gradU[3 * c], _gradU[3 * c + 1], _gradU[3 * c + 2]}});
+    _gradient.Compute(fields);
+
+    const FvmConvection::Stencil stencil = _gradient.Stencil();
+    for (const int c: {U, V, W}) {
+        if (!fvmParameter.calc[c])
+            continue;
+
+        const GhostedFieldRead phi(x[c]);
+        const GhostedFieldRead gx(_gradU[3 * c]), gy(_gradU[3 * c + 1]), gz(_gradU[3 * c + 2]);
+        const FieldWrite bc(b[c]);
+
+        FvmConvection::AddDeferredCorrection(static_cast<FvmConvection::Scheme>(fvmParameter.scheme[c]), stencil,
+                                             _massFlux.data(), phi.Data(), gx.Data(), gy.Data(), gz.Data(),
+                                             bc.Data(), fvmParameter.blend, fvmParameter.kq);
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmConvection"), 0, 0, 0, 0);
+}
@@ -0,0 +1,67 @@
+#ifndef FVMMOMENTUM_HPP
+#define FVMMOMENTUM_HPP
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Globals.hpp"
+#include "FvmGradient.hpp"
+
+#include "petscvec.h"
+
+class FvmMeshContainer;
+class FvmVar;
+
+/**
+ * Momentum coefficients shared by FvmFlowSolver and FvmCoupledSolver, so
+ * both solvers discretise u, v and w the same way: implicit upwind
+ * convection, central diffusion, the time derivative, gravity and the
+ * ef[U] under-relaxation, plus the deferred correction of the convection
+ * scheme of every component (fvmParameter.scheme, FvmConvection).
+ *
+ * Assemble leaves the relaxed diagonal in ap, the sources in bu, bv and bw
+ * and the off-diagonal coefficients per face; each solver then copies them
+ * into its own matrix layout.
+ */
+class FvmMomentum {
+public:
+    FvmMomentum(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar,
+                const FvmGradient &gradient);
+
+    ~FvmMomentum();
+
+    FvmMomentum(const FvmMomentum &) = delete;
+
+    FvmMomentum &operator=(const FvmMomentum &) = delete;
+
+    //! Coefficients of the current iterate; ghosts of xu, xv and xw must be current
+    void Assemble(double dt);
+
+    //! Coefficient of the neighbour in the owner row of a face with a neighbour
+    [[nodiscard]] double OwnerCoefficient(const int face) const { return _ownerCoefficients[face]; }
+
+    //! Coefficient of the owner in the neighbour row of a face with a local neighbour
+    [[nodiscard]] double NeighbourCoefficient(const int face) const { return _neighbourCoefficients[face]; }
+
+private:
+    //! Explicit part of the convection schemes of u, v and w in bu, bv, bw
+    void AddConvectionCorrection();
+
+private:
+    std::shared_ptr<FvmMeshContainer> _fvmMesh;
+    std::shared_ptr<FvmVar> _fvmVar;
+
+    const FvmGradient &_gradient;
+
+    bool _steady = false;
+
+    std::vector<double> _ownerCoefficients;
+    std::vector<double> _neighbourCoefficients;
+
+    bool _deferredCorrection = false; //! Some velocity component is not upwind
+    std::vector<double> _massFlux; //! dens_f uf Aj of the last assembly
+    std::array<Vec, 9> _gradU{}; //! Gradients of u, v and w (x, y, z each)
+};
+
+#endif
@@ -19,7 +19,11 @@ public:
     float st = 1.0f;
 
     std::array<int, 6> timemethod{1, 1, 1, 1, 1, 1};
+    // Convection scheme per field (FvmConvection): 0 - upwind, 1 - central, 2 - blended, 3 - QUICK, 4 - TVD
     std::array<int, 6> scheme{1, 1, 1, 1, 1, 1};
+    float blend = 0.5f; // Central share of the blended scheme
+    int gradient = 0; // Cell gradients (0 - Green-Gauss, 1 - least squares)
+    int limiter = 0; // Gradient limiter (0 - none, 1 - Barth-Jespersen, 2 - Venkatakrishnan)
 
     int steady = 0;
     std::array<float, 6> ftol{1e-6f, 1e-6f, 1e-6f, 1e-6f, 1e-6f, 1e-6f};
@@ -32,30 +36,43 @@ public:
     std::array<int, 6> csav{0, 0, 0, 0, 0, 0};
     std::array<int, 6> probe{0, 0, 0, 0, 0, 0};
 
-    int smooth = 1;
+    int smooth = 1; // Laplacian smoothing passes of the volume fraction into xsm (surface tension)
     std::array<int, 3> vortex{0, 0, 0};
     int streamf = 0;
 
     int fvec = 0;
     int cvec = 0;
 
-    float kq = 2.0f;
-    int ncicsamcor = 2;
+    float kq = 2.0f; // Sweby limiter beta of the TVD scheme (1 - minmod, 2 - superbee)
+    int ncicsamcor = 2; // CICSAM blending factor updates of the implicit volume fraction solve
+    float kcicsam = 1.0f; // CICSAM weight of Hyper-C against ULTIMATE-QUICKEST by the interface angle
+    int vofcycles = 0; // Explicit volume fraction sub-steps per flow step (0 - one implicit solve)
 
     std::array<float, 3> g{0.0f, 0.0f, 0.0f};
+    float tref = 293.15f; // Temperature of the material tables when the energy equation is off
 
-    std::array<int, 6> msolver{8, 8, 8, 8, 8, 3};
-    std::array<int, 6> mprecond{4, 4, 4, 4, 4, 4};
+    // Linear solver per field (FvmLinearSolver):
+    // 0 - Richardson, 1 - Chebyshev, 2 - CG, 3 - GMRES, 4 - FGMRES, 5 - BiCGStab, 6 - CGS, 7 - TFQMR, 8 - MINRES
+    std::array<int, 6> msolver{5, 5, 5, 2, 5, 3};
+    // Preconditioner per field: 0 - none, 1 - Jacobi, 2 - SOR, 3 - ILU, 4 - block Jacobi (ILU), 5 - ASM,
+    // 6 - ICC, 7 - GAMG, 8 - Hypre BoomerAMG, 9 - LU, 10 - face-graph agglomeration multigrid
+    std::array<int, 6> mprecond{4, 4, 4, 7, 4, 4};
+    int pclag = 1; // Matrix updates a preconditioner is reused for (1 - rebuilt after every assembly)
 
     int northocor = 10;
+    int npisocor = 2; // Pressure correctors per time step of transient runs (PISO)
+    int coupled = 0; // Solve (u, v, w, p) as one block system instead of SIMPLE/PISO
     float orthof = 1.0f;
 
+    int coo = 1; // Scalar matrix assembly (1 - COO pattern, 0 - exact MatXAIJSetPreallocation and MatSetValues)
+
     std::array<float, 6> mtol{1e-8f, 1e-8f, 1e-8f, 1e-8f, 1e-8f, 1e-8f};
     std::array<int, 6> miter{500, 500, 500, 500, 500, 500};
 
     int restart = 10000;
-    int adjdt = 0;
-    float maxCp = 0.25f;
+    int adjdt = 0; // Adjust dt of transient runs to the Courant number
+    float maxCp = 0.25f; // Largest cell Courant number held by adjdt
+    float maxDt = 0.0f; // Largest dt reached by adjdt (0 - the configured dt)
 
     float t0 = 0.0f;
     float t1 = 0.001f;
@@ -65,6 +82,10 @@ public:
     float pf = 99.5f;
 
     int intbcphysreg = -1;
+
+    int nthreads = 0; // Mesh geometry threads (0 - all hardware threads, 1 per rank under MPI)
+    int renumber = 0; // Cell renumbering (0 - none, 1 - reverse Cuthill-McKee, 2 - Hilbert curve)
+    int keepconn = 0; // Keep the node and face lists of the Face/Element structs next to the CSR storage
 };
 
 extern FvmParameter fvmParameter;
@@ -0,0 +1,71 @@
+#include "FvmRegionIndex.hpp"
+#include "FvmMesh.hpp"
+
+#include <algorithm>
+
+using namespace FvmMesh;
+
+void FvmRegionIndex::Build(const FvmMeshContainer &mesh) {
+    // Counting sort of the items by region: ids, row sizes, then the rows
+    const auto build = [](std::vector<int> &regions, Csr &csr, const std::vector<int> &keys) {
+        regions.clear();
+        for (const int key: keys) {
+            if (key != -1)
+                regions.push_back(key);
+        }
+        std::sort(regions.begin(), regions.end());
+        regions.erase(std::unique(regions.begin(), regions.end()), regions.end());
+
+        const auto row = [&regions](const int key) {
+            return static_cast<int>(std::lower_bound(regions.begin(), regions.end(), key) - regions.begin());
+        };
+
+        csr.offsets.assign(regions.size() + 1, 0);
+        for (const int key: keys) {
+            if (key != -1)
+                ++csr.offsets[row(key) + 1];
+        }
+        for (std::size_t r = 0; r < regions.size(); ++r)
+            csr.offsets[r + 1] += csr.offsets[r];
+
+        csr.indices.resize(csr.offsets.back());
+        std::vector<int> next(csr.offsets.begin(), csr.offsets.end() - 1);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] != -1)
+                csr.indices[next[row(keys[i])]++] = static_cast<int>(i);
+        }
+    };
+
+    // Processor faces keep the neighbour cell ID in physReg
+    std::vector<int> keys(mesh.faces.size(), -1);
+    for (std::size_t i = 0; i < mesh.faces.size(); ++i) {
+        const Face &face = mesh.faces[i];
+        if (face.pair == -1 && face.bc != BndCondType::PROCESSOR)
+            keys[i] = face.physReg;
+    }
+    build(_faceRegions, _regionFaces, keys);
+
+    keys.assign(mesh.elements.size(), -1);
+    for (std::size_t i = 0; i < mesh.elements.size(); ++i)
+        keys[i] = mesh.elements[i].phyReg;
+    build(_cellRegions, _regionCells, keys);
+}
+
+std::span<const int> FvmRegionIndex::Faces(const int physReg) const {
+    const auto it = std::lower_bound(_faceRegions.begin(), _faceRegions.end(), physReg);
+    if (it == _faceRegions.end() || *it != physReg)
+        return {};
+    return _regionFaces.Row(static_cast<int>(it - _faceRegions.begin()));
+}
+
+std::span<const int> FvmRegionIndex::Cells(const int phyReg) const {
+    const auto it = std::lower_bound(_cellRegions.begin(), _cellRegions.end(), phyReg);
+    if (it == _cellRegions.end() || *it != phyReg)
+        return {};
+    return _regionCells.Row(static_cast<int>(it - _cellRegions.begin()));
+}
+
+std::size_t FvmRegionIndex::MemoryBytes() const {
+    return VectorBytes(_faceRegions) + _regionFaces.MemoryBytes() +
+           VectorBytes(_cellRegions) + _regionCells.MemoryBytes();
+}
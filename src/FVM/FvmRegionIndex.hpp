@@ -0,0 +1,36 @@
+#ifndef FVMREGIONINDEX_HPP
+#define FVMREGIONINDEX_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "FvmMeshStorage.hpp"
+
+class FvmMeshContainer;
+
+/**
+ * Faces and cells of every physical region, built once so boundary and
+ * initial conditions scatter per region instead of scanning the mesh per
+ * region. Rows follow the sorted region IDs.
+ */
+class FvmRegionIndex {
+public:
+    void Build(const FvmMeshContainer &mesh);
+
+    //! Boundary faces (no pair, not processor) of physical surface region physReg
+    [[nodiscard]] std::span<const int> Faces(int physReg) const;
+
+    //! Cells of physical volume region phyReg
+    [[nodiscard]] std::span<const int> Cells(int phyReg) const;
+
+    [[nodiscard]] std::size_t MemoryBytes() const;
+
+private:
+    std::vector<int> _faceRegions;
+    FvmMesh::Csr _regionFaces;
+    std::vector<int> _cellRegions;
+    FvmMesh::Csr _regionCells;
+};
+
+#endif
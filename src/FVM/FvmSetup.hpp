@@ -8,6 +8,8 @@
 class FvmMeshContainer;
 class BoundaryConditions;
 class MaterialsBase;
+class FvmVar;
+class FvmMaterialTable;
 
 
 class FvmSetup {
@@ -15,9 +17,12 @@ public:
     FvmSetup(
         const std::shared_ptr<FvmMeshContainer> &fvmMesh,
         const std::shared_ptr<BoundaryConditions> &fvmBndCnd,
-        const std::shared_ptr<MaterialsBase> &materialsBase);
+        const std::shared_ptr<MaterialsBase> &materialsBase,
+        const std::shared_ptr<FvmVar> &fvmVar);
 
-    void SetGhosts() const;
+    //! Numbers the ghost slots of the processor faces; runs before FvmVector::Init
+    //! and the FvmVar allocation, which copy the ghost layout
+    static void SetGhosts(FvmMeshContainer &fvmMesh);
 
     void SetCenters() const;
 
@@ -29,10 +34,14 @@ public:
 
     void SetMaterialProperties(const std::pair<FvmMaterial, FvmMaterial> &materials) const;
 
+    //! Tables built once, for runs updating the properties every step
+    void SetMaterialProperties(const FvmMaterialTable &materialTable) const;
+
 private:
     std::shared_ptr<FvmMeshContainer> _fvmMesh;
     std::shared_ptr<BoundaryConditions> _fvmBndCnd;
     std::shared_ptr<MaterialsBase> _materialsBase;
+    std::shared_ptr<FvmVar> _fvmVar;
 };
 
 
@@ -7,10 +7,21 @@
 #include "parallel.hpp"
 #include "FvmMeshToVtk.hpp"
 #include "FvmMesh.hpp"
+#include "FvmMeshCache.hpp"
+#include "FvmMeshDistribute.hpp"
+#include "FvmFlowSolver.hpp"
+#include "FvmCoupledSolver.hpp"
+#include "FvmEnergySolver.hpp"
+#include "FvmVofSolver.hpp"
+#include "FvmMaterialTable.hpp"
+#include "FvmTimeStep.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmVar.hpp"
 
 #include <petscsys.h>
 
 #include <array>
+#include <cstdio>
 #include <iostream>
 
 
@@ -25,17 +36,51 @@ void FvmSimulation::GenerateMesh(const std::string &filepath) const {
     if (rank == 0) {
         _model->ImportSTEP(filepath);
 
-        const auto meshAlgorithm = std::make_shared<MeshAlgorithm>();
-        meshAlgorithm->maxSize = 2;
-        meshAlgorithm->SetDim(MeshAlgorithm::ALG_3D);
-        meshAlgorithm->quadAllowed = false;
-
-        _model->SetMeshAlgorithm(meshAlgorithm);
+        _model->SetMeshAlgorithm(CreateMeshAlgorithm());
         _model->GenerateMesh();
     }
     MPI_Barrier(MPI_COMM_WORLD);
 }
 
+std::shared_ptr<MeshAlgorithm> FvmSimulation::CreateMeshAlgorithm() {
+    const auto meshAlgorithm = std::make_shared<MeshAlgorithm>();
+    meshAlgorithm->maxSize = 2;
+    meshAlgorithm->SetDim(MeshAlgorithm::ALG_3D);
+    meshAlgorithm->quadAllowed = false;
+
+    return meshAlgorithm;
+}
+
+bool FvmSimulation::LoadFvmMeshCache(const std::string &stepFile, const std::string &cacheDir) {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    int loaded = 0;
+    if (rank == 0) {
+        _meshCacheKey = FvmMeshCache::ComputeKey(stepFile, *CreateMeshAlgorithm(), processorsNb);
+        _meshCachePath = FvmMeshCache::CachePath(cacheDir, _meshCacheKey);
+
+        _globalFvmMesh = FvmMeshCache::Load(_meshCachePath, _meshCacheKey);
+        loaded = _globalFvmMesh ? 1 : 0;
+
+        PetscPrintf(PETSC_COMM_SELF, "\nMesh cache %s: %s\n",
+                    loaded ? "hit" : "miss", _meshCachePath.c_str());
+    }
+    MPI_Bcast(&loaded, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    return loaded == 1;
+}
+
+void FvmSimulation::SaveFvmMeshCache() const {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    if (rank == 0 && _globalFvmMesh && !_meshCachePath.empty()) {
+        if (!FvmMeshCache::Save(*_globalFvmMesh, _meshCachePath, _meshCacheKey))
+            std::cerr << "Failed to write mesh cache: " << _meshCachePath << std::endl;
+    }
+}
+
 void FvmSimulation::DecomposeMesh() const {
     int rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -85,7 +130,57 @@ int FvmSimulation::ConstructGlobalFvmMesh() {
     return LOGICAL_TRUE;
 }
 
-int FvmSimulation::Start(const std::string &filepath) {
+int FvmSimulation::ConstructDistributedFvmMesh() {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    int status = LOGICAL_TRUE;
+    try {
+        const auto mesh = rank == 0 ? _model->GetMeshObject() : nullptr;
+        const auto localMesh = FvmMesh::ScatterMeshPartitions(mesh, PETSC_COMM_WORLD);
+        _localFvmMesh = std::make_shared<FvmMeshContainer>(localMesh);
+    } catch (const FvmException &ex) {
+        std::cerr << "Caught MeshException: " << ex.what()
+                << ", code: " << ex.code() << std::endl;
+        status = LOGICAL_ERROR;
+    }
+
+    int globalStatus;
+    MPI_Allreduce(&status, &globalStatus, 1, MPI_INT, MPI_MIN, PETSC_COMM_WORLD);
+
+    return globalStatus;
+}
+
+std::shared_ptr<FvmMeshContainer> FvmSimulation::GetFvmMesh() const {
+    return _localFvmMesh ? _localFvmMesh : _globalFvmMesh;
+}
+
+void FvmSimulation::WriteCellResults(FILE *fp, const char name, const Vec field, const double time,
+                                     const int iter) const {
+    const auto fvmMesh = GetFvmMesh();
+    const int cellsNb = fvmMesh->IsDistributed() ? fvmMesh->cellOffsets.back() : fvmMesh->elementsNb;
+
+    PetscFPrintf(PETSC_COMM_WORLD, fp, "$ElementData\n1\n\"%c\"\n1\n%g\n3\n%d\n1\n%d\n",
+                 name, time, iter, cellsNb);
+
+    // One synchronized write per rank, in rank order
+    std::string block;
+    {
+        const FieldRead x(field);
+        std::array<char, 64> line{};
+        for (int i = 0; i < x.Size(); ++i) {
+            std::snprintf(line.data(), line.size(), "%d %.9E\n", fvmMesh->cellOffset + i + 1, x[i]);
+            block += line.data();
+        }
+    }
+    PetscSynchronizedFPrintf(PETSC_COMM_WORLD, fp, "%s", block.c_str());
+    PetscSynchronizedFlush(PETSC_COMM_WORLD, fp);
+
+    PetscFPrintf(PETSC_COMM_WORLD, fp, "$EndElementData\n");
+}
+
+int FvmSimulation::Start(const std::string &filepath, const std::shared_ptr<FvmVar> &fvmVar,
+                         const FvmMaterialTable *materialTable) const {
     constexpr int size = ToInt(FieldIndex::Size);
 
     std::array<char, size> var = {'u', 'v', 'w', 'p', 'T', 's'};
@@ -93,26 +188,27 @@ int FvmSimulation::Start(const std::string &filepath) {
     std::array<int, size> fiter = {0};
 
     int iter = 0;
-    int irestart = 0;
 
-    double wtime = 0.0, wdt = 0.0;
-    double maxCp = 0.0;
+    const auto fvmMesh = GetFvmMesh();
+    if (!fvmMesh) {
+        std::cerr << "No FVM mesh to simulate on\n";
+        return LOGICAL_ERROR;
+    }
 
-    double Vc = 0.0, Vt = 0.0, Vcp = 0.0, Vtp = 0.0;
-    double pf = 0.0;
+    const bool steady = fvmParameter.steady == LOGICAL_TRUE;
 
     const std::string residualsFile = filepath + "/residuals";
     const std::string resultsFile = filepath + "/results";
 
-    FILE *fpresults;
-    FILE *fpresiduals;
+    FILE *fpresults = nullptr;
+    FILE *fpresiduals = nullptr;
 
     if (PetscFOpen(PETSC_COMM_WORLD, resultsFile.c_str(), "w", &fpresults) != 0) {
         std::cerr << "Failed to open results file: " << resultsFile << "\n";
         return LOGICAL_ERROR;
     }
 
-    if (fvmParameter.steady == LOGICAL_TRUE) {
+    if (steady) {
         if (PetscFOpen(PETSC_COMM_WORLD, residualsFile.c_str(), "w", &fpresiduals) != 0) {
             std::cerr << "Failed to open residuals file: " << residualsFile << "\n";
             PetscFClose(PETSC_COMM_WORLD, fpresults);
@@ -120,27 +216,149 @@ int FvmSimulation::Start(const std::string &filepath) {
         }
     }
 
-    // PetscPrintf(PETSC_COMM_WORLD, "\n");
-    // PetscPrintf(PETSC_COMM_WORLD, "Allocating memory...\n");
-
-    double startTime, endTime, curTime, dt;
-    startTime = fvmParameter.t0;
+    double endTime, curTime, dt;
     endTime = fvmParameter.t1;
     curTime = fvmParameter.t0;
     dt = fvmParameter.dt;
 
-    // Open the output file for results
-    if (fvmParameter.wbinary == LOGICAL_TRUE) {
-        fpresults = fopen(resultsFile.c_str(), "wb");
-        fprintf(fpresults, "$PostFormat\n");
-        fprintf(fpresults, "%g %d %lu\n", 1.0, 1, sizeof(double));
-        fprintf(fpresults, "$EndPostFormat\n");
-    } else {
-        fpresults = fopen(resultsFile.c_str(), "w");
-        fprintf(fpresults, "$PostFormat\n");
-        fprintf(fpresults, "%g %d %lu\n", 1.0, 0, sizeof(double));
-        fprintf(fpresults, "$EndPostFormat\n");
+    // Results are written as ASCII element data
+    if (fvmParameter.wbinary == LOGICAL_TRUE)
+        PetscPrintf(PETSC_COMM_WORLD, "\nBinary results are not supported, writing ASCII\n");
+
+    PetscFPrintf(PETSC_COMM_WORLD, fpresults, "$PostFormat\n");
+    PetscFPrintf(PETSC_COMM_WORLD, fpresults, "%g %d %lu\n", 1.0, 0, sizeof(double));
+    PetscFPrintf(PETSC_COMM_WORLD, fpresults, "$EndPostFormat\n");
+
+    constexpr int T = ToInt(FieldIndex::T);
+    const bool energy = fvmParameter.calc[T] && fvmVar->IsActive(FvmVar::FieldSet::ENERGY);
+    constexpr int S = ToInt(FieldIndex::S);
+    const bool vof = fvmParameter.calc[S] && fvmVar->IsActive(FvmVar::FieldSet::VOF);
+
+    std::unique_ptr<FvmFlowSolver> flowSolver;
+    std::unique_ptr<FvmCoupledSolver> coupledSolver;
+    std::unique_ptr<FvmEnergySolver> energySolver; // borrows the pattern and gradients of the flow solver
+    std::unique_ptr<FvmVofSolver> vofSolver; // likewise
+    try {
+        if (fvmParameter.coupled == LOGICAL_TRUE)
+            coupledSolver = std::make_unique<FvmCoupledSolver>(fvmMesh, fvmVar);
+        else
+            flowSolver = std::make_unique<FvmFlowSolver>(fvmMesh, fvmVar);
+
+        if (energy) {
+            energySolver = coupledSolver
+                               ? std::make_unique<FvmEnergySolver>(fvmMesh, fvmVar, coupledSolver->Sparsity(),
+                                                                   coupledSolver->GradientOperator())
+                               : std::make_unique<FvmEnergySolver>(fvmMesh, fvmVar, flowSolver->Sparsity(),
+                                                                   flowSolver->GradientOperator());
+        }
+
+        if (vof) {
+            vofSolver = coupledSolver
+                            ? std::make_unique<FvmVofSolver>(fvmMesh, fvmVar, coupledSolver->Sparsity(),
+                                                             coupledSolver->GradientOperator())
+                            : std::make_unique<FvmVofSolver>(fvmMesh, fvmVar, flowSolver->Sparsity(),
+                                                             flowSolver->GradientOperator());
+        }
+    } catch (const FvmException &ex) {
+        std::cerr << "Caught FvmException: " << ex.what() << ", code: " << ex.code() << std::endl;
+        PetscFClose(PETSC_COMM_WORLD, fpresults);
+        if (fpresiduals)
+            PetscFClose(PETSC_COMM_WORLD, fpresiduals);
+        return LOGICAL_ERROR;
     }
 
+    // Temperature-dependent tables follow every energy solve, not only the interface
+    const bool thermalProperties = energy && materialTable && materialTable->TemperatureDependent();
+    if (materialTable)
+        materialTable->Evaluate(*fvmVar);
+
+    const FvmTimeStep timeStep(fvmMesh, fvmVar);
+    const bool adjustTimeStep = !steady && fvmParameter.adjdt == LOGICAL_TRUE;
+
+    // Steady runs take (t1 - t0) / dt SIMPLE iterations at most
+    bool converged = false;
+    while (curTime < endTime - 0.5 * dt && !converged) {
+        ++iter;
+
+        // Courant number of the face velocities of the last step
+        double courant = 0.0;
+        if (adjustTimeStep) {
+            courant = timeStep.ComputeCourant(dt);
+            const double adjusted = LMIN(FvmTimeStep::Adjust(dt, courant), endTime - curTime);
+            courant *= adjusted / dt;
+            dt = adjusted;
+        }
+        curTime += dt;
+
+        if (!steady) {
+            VecCopy(fvmVar->xu, fvmVar->xu0);
+            VecCopy(fvmVar->xv, fvmVar->xv0);
+            VecCopy(fvmVar->xw, fvmVar->xw0);
+            VecCopy(fvmVar->xp, fvmVar->xp0);
+            if (energy)
+                VecCopy(fvmVar->xT, fvmVar->xT0);
+            if (vof)
+                VecCopy(fvmVar->xs, fvmVar->xs0);
+        }
+
+        // Interface moves on the face fluxes of the last step, then the mixture properties follow
+        if (vofSolver) {
+            vofSolver->Iterate(dt, fres, fiter);
+            if (materialTable)
+                materialTable->Evaluate(*fvmVar);
+        }
+
+        if (coupledSolver)
+            coupledSolver->Iterate(dt, fres, fiter);
+        else
+            flowSolver->Iterate(dt, fres, fiter);
+
+        // Temperature follows the face fluxes just corrected; its properties act in the next flow step
+        if (energySolver) {
+            energySolver->Iterate(dt, fres, fiter);
+            if (thermalProperties)
+                materialTable->Evaluate(*fvmVar);
+        }
+
+        if (steady)
+            PetscPrintf(PETSC_COMM_WORLD, "\nIteration: %d\n", iter);
+        else
+            PetscPrintf(PETSC_COMM_WORLD, "\nTime: %g %s, step: %d\n", curTime, fvmParameter.utime.c_str(), iter);
+        if (adjustTimeStep)
+            PetscPrintf(PETSC_COMM_WORLD, "  dt: %g %s, Courant number: %.3f\n", dt, fvmParameter.utime.c_str(),
+                        courant);
+
+        converged = steady;
+        for (const int c: {0, 1, 2, 3, T, S}) {
+            if (!fvmParameter.calc[c] || (c == T && !energy) || (c == S && !vof))
+                continue;
+
+            PetscPrintf(PETSC_COMM_WORLD, "  %c: residual %.3E, %d iterations\n", var[c], fres[c], fiter[c]);
+            converged = converged && fres[c] < fvmParameter.ftol[c];
+        }
+
+        if (steady) {
+            PetscFPrintf(PETSC_COMM_WORLD, fpresiduals, "%d %.6E %.6E %.6E %.6E", iter,
+                         fres[0], fres[1], fres[2], fres[3]);
+            if (energy)
+                PetscFPrintf(PETSC_COMM_WORLD, fpresiduals, " %.6E", fres[T]);
+            PetscFPrintf(PETSC_COMM_WORLD, fpresiduals, "\n");
+        }
+
+        if (iter % LMAX(fvmParameter.nsav, 1) == 0 || converged) {
+            for (int c = 0; c <= S; ++c) {
+                if (fvmParameter.calc[c] && fvmParameter.csav[c] && (c != T || energy) && (c != S || vof))
+                    WriteCellResults(fpresults, var[c], fvmVar->Get(std::string("x") + var[c]), curTime, iter);
+            }
+        }
+    }
+
+    if (converged)
+        PetscPrintf(PETSC_COMM_WORLD, "\nConverged after %d iterations\n", iter);
+
+    PetscFClose(PETSC_COMM_WORLD, fpresults);
+    if (fpresiduals)
+        PetscFClose(PETSC_COMM_WORLD, fpresiduals);
+
     return LOGICAL_TRUE;
 }
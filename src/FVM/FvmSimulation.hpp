@@ -1,11 +1,19 @@
 #ifndef FVMSIMULATION_HPP
 #define FVMSIMULATION_HPP
 
+#include <cstdint>
+#include <cstdio>
+#include <memory>
 #include <string>
 
 #include "Model.hpp"
 
+#include "petscvec.h"
+
 class FvmMeshContainer;
+class FvmVar;
+class FvmMaterialTable;
+class MeshAlgorithm;
 
 class FvmSimulation {
 public:
@@ -15,17 +23,42 @@ public:
 
     void GenerateMesh(const std::string &filepath) const;
 
+    //! Loads the global FVM mesh on rank 0 from <cacheDir>; true on a cache hit (on all ranks)
+    bool LoadFvmMeshCache(const std::string &stepFile, const std::string &cacheDir);
+
+    //! Writes the global FVM mesh to the path chosen by LoadFvmMeshCache
+    void SaveFvmMeshCache() const;
+
     int ConstructGlobalFvmMesh();
 
+    //! Scatters mesh partitions from rank 0 and builds the local FVM mesh on every rank
+    int ConstructDistributedFvmMesh();
+
     void ExportMeshPartitions() const;
 
     void DecomposeMesh() const;
 
-    static int Start(const std::string &filepath);
+    //! FVM mesh of this rank: the local partition, else the global mesh
+    [[nodiscard]] std::shared_ptr<FvmMeshContainer> GetFvmMesh() const;
+
+    //! Runs the flow solver from t0 to t1; results and residuals go to filepath. A material table
+    //! sets the properties of the initial fields and refreshes them after every volume fraction
+    //! step and, when they follow the temperature, after every energy step
+    int Start(const std::string &filepath, const std::shared_ptr<FvmVar> &fvmVar,
+              const FvmMaterialTable *materialTable = nullptr) const;
+
+private:
+    static std::shared_ptr<MeshAlgorithm> CreateMeshAlgorithm();
+
+    void WriteCellResults(FILE *fp, char name, Vec field, double time, int iter) const;
 
 private:
     std::unique_ptr<Model> _model;
     std::shared_ptr<FvmMeshContainer> _globalFvmMesh;
+    std::shared_ptr<FvmMeshContainer> _localFvmMesh;
+
+    std::string _meshCachePath;
+    std::uint64_t _meshCacheKey = 0;
 };
 
 
@@ -0,0 +1,155 @@
+#include "FvmSparsity.hpp"
+#include "FvmMesh.hpp"
+#include "Globals.hpp"
+#include "FvmParam.hpp"
+
+#include <numeric>
+
+FvmSparsity::FvmSparsity(const FvmMeshContainer &mesh)
+    : _rowsNb(mesh.elementsNb),
+      _diagonalNz(mesh.elementsNb, 1),
+      _offDiagonalNz(mesh.elementsNb, 0) {
+    for (int e = 0; e < mesh.elementsNb; ++e) {
+        for (const int index: mesh.storage.elementFaces.Row(e)) {
+            if (index == -1)
+                continue;
+
+            const auto &face = mesh.faces[index];
+            if (face.pair != -1)
+                ++_diagonalNz[e];
+            else if (face.bc == BndCondType::PROCESSOR)
+                ++_offDiagonalNz[e];
+        }
+    }
+
+    const int facesNb = static_cast<int>(mesh.faces.size());
+    const std::size_t entriesNb = std::accumulate(_diagonalNz.begin(), _diagonalNz.end(), std::size_t{0}) +
+                                  std::accumulate(_offDiagonalNz.begin(), _offDiagonalNz.end(), std::size_t{0});
+    _cooRows.reserve(entriesNb);
+    _cooColumns.reserve(entriesNb);
+    _ownerEntries.assign(facesNb, -1);
+    _neighbourEntries.assign(facesNb, -1);
+
+    for (int i = 0; i < _rowsNb; ++i) {
+        _cooRows.push_back(mesh.cellOffset + i);
+        _cooColumns.push_back(mesh.cellOffset + i);
+    }
+
+    for (const auto &face: mesh.faces) {
+        const PetscInt owner = mesh.cellOffset + face.owner;
+
+        if (face.pair != -1) {
+            const PetscInt pair = mesh.cellOffset + face.pair;
+
+            _ownerEntries[face.index] = static_cast<int>(_cooRows.size());
+            _cooRows.push_back(owner);
+            _cooColumns.push_back(pair);
+
+            _neighbourEntries[face.index] = static_cast<int>(_cooRows.size());
+            _cooRows.push_back(pair);
+            _cooColumns.push_back(owner);
+        } else if (face.bc == BndCondType::PROCESSOR) {
+            // physReg holds the global ID of the ghost cell
+            _ownerEntries[face.index] = static_cast<int>(_cooRows.size());
+            _cooRows.push_back(owner);
+            _cooColumns.push_back(face.physReg);
+        }
+    }
+
+    if (fvmParameter.coo != LOGICAL_TRUE) {
+        // Counting sort of the entries by row, so SetValues inserts one row per call
+        _rowOffsets.assign(_rowsNb + 1, 0);
+        for (const PetscInt row: _cooRows)
+            ++_rowOffsets[row - mesh.cellOffset + 1];
+        std::partial_sum(_rowOffsets.begin(), _rowOffsets.end(), _rowOffsets.begin());
+
+        std::vector<int> next(_rowOffsets.begin(), _rowOffsets.end() - 1);
+        _rowEntries.resize(_cooRows.size());
+        _rowColumns.resize(_cooRows.size());
+        for (int k = 0; k < static_cast<int>(_cooRows.size()); ++k) {
+            const int position = next[_cooRows[k] - mesh.cellOffset]++;
+            _rowEntries[position] = k;
+            _rowColumns[position] = _cooColumns[k];
+        }
+    }
+
+    const double entriesNbLocal = static_cast<double>(_cooRows.size());
+    MPI_Allreduce(&entriesNbLocal, &_globalEntriesNb, 1, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+}
+
+void FvmSparsity::CreateMatrix(Mat *matrix, const PetscInt blockSize) const {
+    MatCreate(PETSC_COMM_WORLD, matrix);
+    MatSetSizes(*matrix, _rowsNb * blockSize, _rowsNb * blockSize, PETSC_DETERMINE, PETSC_DETERMINE);
+    MatSetType(*matrix, blockSize > 1 ? MATBAIJ : MATAIJ);
+    MatSetBlockSize(*matrix, blockSize);
+    MatSetFromOptions(*matrix);
+    MatXAIJSetPreallocation(*matrix, blockSize, _diagonalNz.data(), _offDiagonalNz.data(), nullptr, nullptr);
+
+    // Rows are only set by their owner, in the preallocated pattern
+    MatSetOption(*matrix, MAT_NO_OFF_PROC_ENTRIES, PETSC_TRUE);
+    MatSetOption(*matrix, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_TRUE);
+}
+
+void FvmSparsity::CreateCooMatrix(Mat *matrix) const {
+    MatCreate(PETSC_COMM_WORLD, matrix);
+    MatSetSizes(*matrix, _rowsNb, _rowsNb, PETSC_DETERMINE, PETSC_DETERMINE);
+    MatSetType(*matrix, MATAIJ);
+    MatSetFromOptions(*matrix);
+
+    // PETSc may reorder the index arrays it is given
+    std::vector<PetscInt> rows(_cooRows), columns(_cooColumns);
+    MatSetPreallocationCOO(*matrix, static_cast<PetscCount>(rows.size()), rows.data(), columns.data());
+}
+
+void FvmSparsity::CreateScalarMatrix(Mat *matrix) const {
+    if (fvmParameter.coo == LOGICAL_TRUE)
+        CreateCooMatrix(matrix);
+    else
+        CreateMatrix(matrix);
+}
+
+void FvmSparsity::SetValues(const Mat matrix, const std::vector<PetscScalar> &coefficients) const {
+    if (fvmParameter.coo == LOGICAL_TRUE) {
+        MatSetValuesCOO(matrix, coefficients.data(), INSERT_VALUES);
+        return;
+    }
+
+    std::vector<PetscScalar> values;
+    for (int i = 0; i < _rowsNb; ++i) {
+        const int begin = _rowOffsets[i], end = _rowOffsets[i + 1];
+        values.resize(end - begin);
+        for (int k = begin; k < end; ++k)
+            values[k - begin] = coefficients[_rowEntries[k]];
+
+        const PetscInt row = _cooRows[i]; // Entry i is the diagonal of cell i
+        MatSetValues(matrix, 1, &row, end - begin, &_rowColumns[begin], values.data(), INSERT_VALUES);
+    }
+
+    MatAssemblyBegin(matrix, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(matrix, MAT_FINAL_ASSEMBLY);
+}
+
+void FvmSparsity::CheckAssembly(const Mat matrix, const char *name) const {
+    // The pattern is fixed, so one check per matrix suffices outside debugging runs
+    const bool first = _checkedMatrices.insert(matrix).second;
+    if (!first && !verbose && !pchecks)
+        return;
+
+    MatInfo info;
+    MatGetInfo(matrix, MAT_GLOBAL_SUM, &info);
+
+    // Blocked matrices hold a dense block per pattern entry
+    PetscInt blockSize;
+    MatGetBlockSize(matrix, &blockSize);
+    const double expected = _globalEntriesNb * static_cast<double>(blockSize * blockSize);
+
+    // Preallocated (CreateMatrix) matrices must also assemble without mallocs and leave no slot unused
+    if (info.nz_used != expected || info.nz_unneeded > 0 || info.mallocs > 0) {
+        PetscPrintf(PETSC_COMM_WORLD,
+                    "Warning: %s has %.0f nonzeros, %.0f unused slots and %.0f mallocs, the face pattern %.0f\n",
+                    name, info.nz_used, info.nz_unneeded, info.mallocs, expected);
+    } else if (verbose || pchecks) {
+        PetscPrintf(PETSC_COMM_WORLD, "%s: %.0f nonzeros, matching the face pattern, 0 mallocs\n", name,
+                    info.nz_used);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef FVMSPARSITY_HPP
+#define FVMSPARSITY_HPP
+
+#include <set>
+#include <vector>
+
+#include "petscmat.h"
+
+class FvmMeshContainer;
+
+/**
+ * Nonzero layout of the cell operators: row i holds the cell itself, its
+ * pair across every interior face (diagonal block) and its ghost across
+ * every processor face (off-diagonal block). Counts are taken from
+ * storage.elementFaces once and shared by the momentum, pressure and scalar
+ * matrices, so assembly never allocates.
+ *
+ * The same pattern is also laid out as a fixed COO entry list: entry i is
+ * the diagonal of cell i, followed per face by its (owner, neighbour) entry
+ * and, for interior faces, its (neighbour, owner) entry. Assembly fills a
+ * flat coefficient array in this order and hands it to SetValues: through
+ * MatSetValuesCOO (fvmParameter.coo = 1), or row by row with MatSetValues
+ * into the preallocated matrix (coo = 0), where CheckAssembly proves that
+ * the assembly needed no mallocs.
+ */
+class FvmSparsity {
+public:
+    explicit FvmSparsity(const FvmMeshContainer &mesh);
+
+    //! AIJ matrix (BAIJ for blockSize > 1) with exact preallocation
+    void CreateMatrix(Mat *matrix, PetscInt blockSize = 1) const;
+
+    //! AIJ matrix with the COO pattern registered (MatSetPreallocationCOO)
+    void CreateCooMatrix(Mat *matrix) const;
+
+    //! Momentum, pressure and scalar matrices: CreateCooMatrix or CreateMatrix by fvmParameter.coo
+    void CreateScalarMatrix(Mat *matrix) const;
+
+    //! Inserts the coefficients of the COO entry list and assembles the matrix
+    void SetValues(Mat matrix, const std::vector<PetscScalar> &coefficients) const;
+
+    [[nodiscard]] int EntriesNumber() const { return static_cast<int>(_cooRows.size()); }
+
+    //! COO entry of the diagonal of cell i
+    [[nodiscard]] static int DiagonalEntry(const int cell) { return cell; }
+
+    //! COO entry (owner, neighbour) of face i, -1 on boundaries
+    [[nodiscard]] int OwnerEntry(const int face) const { return _ownerEntries[face]; }
+
+    //! COO entry (neighbour, owner) of interior face i, -1 otherwise
+    [[nodiscard]] int NeighbourEntry(const int face) const { return _neighbourEntries[face]; }
+
+    /**
+     * Compares the nonzeros of the assembled matrix with the COO pattern
+     * (times the block size squared for blocked matrices); a different
+     * count means duplicate or missing entries (e.g. two faces between the
+     * same cells). For CreateMatrix matrices, mallocs during assembly or
+     * unused preallocated slots show that the preallocation is not exact.
+     * MatGetInfo reduces over all ranks, so a matrix is checked after its
+     * first assembly only, or after every assembly when verbose or pchecks
+     * is set (which also prints the count). Mismatches always warn.
+     */
+    void CheckAssembly(Mat matrix, const char *name) const;
+
+    [[nodiscard]] const std::vector<PetscInt> &DiagonalNonzeros() const { return _diagonalNz; }
+
+    [[nodiscard]] const std::vector<PetscInt> &OffDiagonalNonzeros() const { return _offDiagonalNz; }
+
+private:
+    int _rowsNb = 0;
+    std::vector<PetscInt> _diagonalNz;
+    std::vector<PetscInt> _offDiagonalNz;
+
+    std::vector<PetscInt> _cooRows, _cooColumns; //! Global indices
+    double _globalEntriesNb = 0.0; //! COO entries of all ranks
+    std::vector<int> _ownerEntries, _neighbourEntries;
+
+    //! COO entries grouped by local row (coo = 0): entries of row i are
+    //! _rowEntries[_rowOffsets[i] ... _rowOffsets[i + 1])
+    std::vector<int> _rowOffsets, _rowEntries;
+    std::vector<PetscInt> _rowColumns; //! Global columns in _rowEntries order
+    mutable std::set<Mat> _checkedMatrices; //! Matrices past their first CheckAssembly
+};
+
+#endif
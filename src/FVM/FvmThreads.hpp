@@ -0,0 +1,66 @@
+#ifndef FVMTHREADS_HPP
+#define FVMTHREADS_HPP
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "FvmParam.hpp"
+#include "parallel.hpp"
+
+//! Number of worker threads for shared-memory loops (fvmParameter.nthreads).
+//! 0 selects all hardware threads on a single rank and one thread per rank
+//! under MPI, where the ranks already share the cores of a node.
+inline int ThreadsNumber() {
+    if (fvmParameter.nthreads > 0)
+        return fvmParameter.nthreads;
+
+    if (processorsNb > 1)
+        return 1;
+
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+/**
+ * Splits [0, n) into contiguous chunks, one per thread, and calls
+ * body(begin, end) for each chunk. The partition depends only on n and
+ * the thread count, so per-item results are identical to a serial loop.
+ * The exception of the lowest failing chunk is rethrown.
+ */
+template<typename Body>
+void ParallelFor(const int n, const int threadsNb, Body &&body) {
+    const int chunksNb = std::clamp(threadsNb, 1, std::max(n, 1));
+    if (chunksNb == 1) {
+        body(0, n);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(chunksNb);
+    std::vector<std::thread> workers;
+    workers.reserve(chunksNb - 1);
+
+    auto run = [&](const int chunk) {
+        const int begin = static_cast<int>(static_cast<long long>(n) * chunk / chunksNb);
+        const int end = static_cast<int>(static_cast<long long>(n) * (chunk + 1) / chunksNb);
+        try {
+            body(begin, end);
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    for (int chunk = 1; chunk < chunksNb; ++chunk)
+        workers.emplace_back(run, chunk);
+    run(0);
+
+    for (auto &worker: workers)
+        worker.join();
+
+    for (const auto &error: errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+#endif
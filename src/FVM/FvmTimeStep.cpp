@@ -0,0 +1,58 @@
+#include "FvmTimeStep.hpp"
+#include "FvmMesh.hpp"
+#include "FvmVar.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmLog.hpp"
+#include "FvmParam.hpp"
+
+FvmTimeStep::FvmTimeStep(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar)
+    : _fvmMesh(fvmMesh),
+      _fvmVar(fvmVar) {
+}
+
+double FvmTimeStep::ComputeCourant(const double dt) const {
+    PetscLogEventBegin(FvmLog::Event("FvmCourant"), 0, 0, 0, 0);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto elements = _fvmMesh->storage.Elements();
+
+    double localMax = 0.0;
+    {
+        const GhostedFieldRead uf(_fvmVar->uf);
+        const FieldWrite Co(_fvmVar->Co);
+
+        for (int i = 0; i < elementsNb; ++i)
+            Co[i] = 0.0;
+
+        // Both cells of an interior face see the same volume flux
+        for (int i = 0; i < faces.size; ++i) {
+            const double flux = LABS(uf[i]) * faces.Aj[i];
+            Co[faces.owner[i]] += flux;
+            if (faces.pair[i] != -1)
+                Co[faces.pair[i]] += flux;
+        }
+
+        for (int i = 0; i < elementsNb; ++i) {
+            Co[i] *= 0.5 * dt / elements.Vp[i];
+            localMax = LMAX(localMax, Co[i]);
+        }
+    }
+
+    double globalMax;
+    MPI_Allreduce(&localMax, &globalMax, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+
+    PetscLogEventEnd(FvmLog::Event("FvmCourant"), 0, 0, 0, 0);
+
+    return globalMax;
+}
+
+double FvmTimeStep::Adjust(const double dt, const double courant) {
+    // Growth stops at maxDt, also without flow (startup, quiescent regions)
+    const double maxDt = fvmParameter.maxDt > 0.0f ? fvmParameter.maxDt : fvmParameter.dt;
+
+    if (courant < SMALL)
+        return LMIN(dt * growthLimit, maxDt);
+
+    return LMIN(dt * LMIN(fvmParameter.maxCp / courant, growthLimit), maxDt);
+}
@@ -0,0 +1,33 @@
+#ifndef FVMTIMESTEP_HPP
+#define FVMTIMESTEP_HPP
+
+#include <memory>
+
+class FvmMeshContainer;
+class FvmVar;
+
+/**
+ * Courant number control of transient runs (fvmParameter.adjdt). The cell
+ * Courant number is Co = dt / (2 Vp) sum_f |uf| Aj, taken from the face
+ * velocities of the last step; the step then shrinks at once or grows by
+ * at most growthLimit per step to hold the largest one at fvmParameter.maxCp,
+ * never beyond fvmParameter.maxDt (the configured dt when unset).
+ */
+class FvmTimeStep {
+public:
+    FvmTimeStep(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar);
+
+    //! Fills fvmVar->Co for step dt; returns the global maximum
+    [[nodiscard]] double ComputeCourant(double dt) const;
+
+    //! Step bringing the largest Courant number courant of step dt to maxCp
+    [[nodiscard]] static double Adjust(double dt, double courant);
+
+private:
+    static constexpr double growthLimit = 1.2;
+
+    std::shared_ptr<FvmMeshContainer> _fvmMesh;
+    std::shared_ptr<FvmVar> _fvmVar;
+};
+
+#endif
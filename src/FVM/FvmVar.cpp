@@ -1,239 +1,192 @@
 #include "FvmVar.hpp"
 #include "FvmVector.hpp"
 #include "FvmMesh.hpp"
+#include "FvmParam.hpp"
+#include "Globals.hpp"
+
+#include <array>
 
 #define DESTROY_MAT(m) if ((m) != nullptr) { MatDestroy(&(m)); (m) = nullptr; }
 #define DESTROY_VEC(v) if ((v) != nullptr) { VecDestroy(&(v)); (v) = nullptr; }
 
-Vec FvmVar::cex;
-Vec FvmVar::cey;
-Vec FvmVar::cez;
-Vec FvmVar::cexl;
-Vec FvmVar::ceyl;
-Vec FvmVar::cezl;
-
-Vec FvmVar::Co;
-Vec FvmVar::Col;
-
-Vec FvmVar::uf;
-
-Vec FvmVar::dens;
-Vec FvmVar::visc;
-Vec FvmVar::spheat;
-Vec FvmVar::thcond;
-
-Vec FvmVar::densl;
-Vec FvmVar::viscl;
-Vec FvmVar::spheatl;
-Vec FvmVar::thcondl;
-
-Vec FvmVar::xu0;
-Vec FvmVar::xv0;
-Vec FvmVar::xw0;
-Vec FvmVar::xp0;
-Vec FvmVar::xT0;
-Vec FvmVar::xs0;
-
-Vec FvmVar::xu0l;
-Vec FvmVar::xv0l;
-Vec FvmVar::xw0l;
-Vec FvmVar::xp0l;
-Vec FvmVar::xT0l;
-Vec FvmVar::xs0l;
-
-Vec FvmVar::xu;
-Vec FvmVar::xv;
-Vec FvmVar::xw;
-Vec FvmVar::xp;
-Vec FvmVar::xT;
-Vec FvmVar::xs;
-
-Vec FvmVar::xul;
-Vec FvmVar::xvl;
-Vec FvmVar::xwl;
-Vec FvmVar::xpl;
-Vec FvmVar::xTl;
-Vec FvmVar::xsl;
-
-Vec FvmVar::xuf;
-Vec FvmVar::xvf;
-Vec FvmVar::xwf;
-Vec FvmVar::xpf;
-Vec FvmVar::xTf;
-Vec FvmVar::xsf;
-
-Mat FvmVar::Am;
-Mat FvmVar::Ac;
-Mat FvmVar::Ae;
-Mat FvmVar::As;
-
-Vec FvmVar::bu;
-Vec FvmVar::bv;
-Vec FvmVar::bw;
-Vec FvmVar::bp;
-Vec FvmVar::bT;
-Vec FvmVar::bs;
-
-Vec FvmVar::hu;
-Vec FvmVar::hv;
-Vec FvmVar::hw;
-
-Vec FvmVar::hul;
-Vec FvmVar::hvl;
-Vec FvmVar::hwl;
-
-Vec FvmVar::ap;
-Vec FvmVar::apl;
-
-Vec FvmVar::xpp;
-Vec FvmVar::xTp;
-
-Vec FvmVar::betaf;
-
-Vec FvmVar::temp1;
-Vec FvmVar::temp2;
-
-Vec FvmVar::xsm;
-Vec FvmVar::xsml;
-Vec FvmVar::xsmf;
+namespace {
+    enum class Layout {
+        CELL, // ghosted, one entry per cell
+        FACE, // one entry per local face (FvmVector::V_ConstrFace)
+        SOLVER // created by the solver, only destroyed here
+    };
+
+    struct FieldInfo {
+        const char *name;
+        Vec FvmVar::*member;
+        Layout layout;
+        FvmVar::FieldSet set;
+    };
+
+    using enum FvmVar::FieldSet;
+
+    constexpr std::array FIELDS{
+        FieldInfo{"cex", &FvmVar::cex, Layout::CELL, ALWAYS},
+        FieldInfo{"cey", &FvmVar::cey, Layout::CELL, ALWAYS},
+        FieldInfo{"cez", &FvmVar::cez, Layout::CELL, ALWAYS},
+        FieldInfo{"Co", &FvmVar::Co, Layout::CELL, COURANT},
+        FieldInfo{"uf", &FvmVar::uf, Layout::FACE, ALWAYS},
+        FieldInfo{"dens", &FvmVar::dens, Layout::CELL, ALWAYS},
+        FieldInfo{"visc", &FvmVar::visc, Layout::CELL, ALWAYS},
+        FieldInfo{"spheat", &FvmVar::spheat, Layout::CELL, ENERGY},
+        FieldInfo{"thcond", &FvmVar::thcond, Layout::CELL, ENERGY},
+
+        FieldInfo{"xu0", &FvmVar::xu0, Layout::CELL, ALWAYS},
+        FieldInfo{"xv0", &FvmVar::xv0, Layout::CELL, ALWAYS},
+        FieldInfo{"xw0", &FvmVar::xw0, Layout::CELL, ALWAYS},
+        FieldInfo{"xp0", &FvmVar::xp0, Layout::CELL, ALWAYS},
+        FieldInfo{"xT0", &FvmVar::xT0, Layout::CELL, ENERGY},
+        FieldInfo{"xs0", &FvmVar::xs0, Layout::CELL, VOF},
+
+        FieldInfo{"xu", &FvmVar::xu, Layout::CELL, ALWAYS},
+        FieldInfo{"xv", &FvmVar::xv, Layout::CELL, ALWAYS},
+        FieldInfo{"xw", &FvmVar::xw, Layout::CELL, ALWAYS},
+        FieldInfo{"xp", &FvmVar::xp, Layout::CELL, ALWAYS},
+        FieldInfo{"xT", &FvmVar::xT, Layout::CELL, ENERGY},
+        FieldInfo{"xs", &FvmVar::xs, Layout::CELL, VOF},
+
+        FieldInfo{"xuf", &FvmVar::xuf, Layout::FACE, ALWAYS},
+        FieldInfo{"xvf", &FvmVar::xvf, Layout::FACE, ALWAYS},
+        FieldInfo{"xwf", &FvmVar::xwf, Layout::FACE, ALWAYS},
+        FieldInfo{"xpf", &FvmVar::xpf, Layout::FACE, ALWAYS},
+        FieldInfo{"xTf", &FvmVar::xTf, Layout::FACE, ENERGY},
+        FieldInfo{"xsf", &FvmVar::xsf, Layout::FACE, VOF},
+
+        FieldInfo{"ap", &FvmVar::ap, Layout::CELL, FLOW},
+        FieldInfo{"hu", &FvmVar::hu, Layout::CELL, FLOW},
+        FieldInfo{"hv", &FvmVar::hv, Layout::CELL, FLOW},
+        FieldInfo{"hw", &FvmVar::hw, Layout::CELL, FLOW},
+        FieldInfo{"temp1", &FvmVar::temp1, Layout::CELL, FLOW},
+        FieldInfo{"temp2", &FvmVar::temp2, Layout::CELL, FLOW},
+
+        FieldInfo{"xsm", &FvmVar::xsm, Layout::CELL, VOF},
+        FieldInfo{"xsmf", &FvmVar::xsmf, Layout::FACE, VOF},
+
+        FieldInfo{"bu", &FvmVar::bu, Layout::SOLVER, FLOW},
+        FieldInfo{"bv", &FvmVar::bv, Layout::SOLVER, FLOW},
+        FieldInfo{"bw", &FvmVar::bw, Layout::SOLVER, FLOW},
+        FieldInfo{"bp", &FvmVar::bp, Layout::SOLVER, FLOW},
+        FieldInfo{"bT", &FvmVar::bT, Layout::SOLVER, ENERGY},
+        FieldInfo{"bs", &FvmVar::bs, Layout::SOLVER, VOF},
+        FieldInfo{"xpp", &FvmVar::xpp, Layout::SOLVER, FLOW},
+        FieldInfo{"xTp", &FvmVar::xTp, Layout::SOLVER, ENERGY},
+        FieldInfo{"betaf", &FvmVar::betaf, Layout::SOLVER, VOF},
+    };
+
+    const FieldInfo *FindField(const std::string &name) {
+        for (const auto &field: FIELDS) {
+            if (name == field.name)
+                return &field;
+        }
+        return nullptr;
+    }
+
+    std::size_t VecBytes(const Vec v) {
+        if (v == nullptr)
+            return 0;
+
+        Vec local = nullptr;
+        PetscInt size;
+        VecGhostGetLocalForm(v, &local);
+        if (local) {
+            VecGetLocalSize(local, &size);
+            VecGhostRestoreLocalForm(v, &local);
+        } else {
+            VecGetLocalSize(v, &size);
+        }
+        return static_cast<std::size_t>(size) * sizeof(PetscScalar);
+    }
+}
 
 FvmVar::FvmVar(const std::shared_ptr<FvmMeshContainer> &fvmMesh)
     : _fvmMesh(fvmMesh) {
     const int elementsNb = fvmMesh->elementsNb;
-    const int facesNb = fvmMesh->facesNb;
-
-    FvmVector::V_Constr(&cex, elementsNb, 0);
-    FvmVector::V_Constr(&cey, elementsNb, 0);
-    FvmVector::V_Constr(&cez, elementsNb, 0);
-
-    FvmVector::V_Constr(&Co, elementsNb, 0);
-    FvmVector::V_Constr(&uf, facesNb, 1);
-
-    FvmVector::V_Constr(&dens, elementsNb, 0);
-    FvmVector::V_Constr(&visc, elementsNb, 0);
-    FvmVector::V_Constr(&thcond, elementsNb, 0);
-    FvmVector::V_Constr(&spheat, elementsNb, 0);
-
-    FvmVector::V_Constr(&xu0, elementsNb, 0);
-    FvmVector::V_Constr(&xv0, elementsNb, 0);
-    FvmVector::V_Constr(&xw0, elementsNb, 0);
-    FvmVector::V_Constr(&xp0, elementsNb, 0);
-    FvmVector::V_Constr(&xT0, elementsNb, 0);
-    FvmVector::V_Constr(&xs0, elementsNb, 0);
-
-    FvmVector::V_Constr(&xu, elementsNb, 0);
-    FvmVector::V_Constr(&xv, elementsNb, 0);
-    FvmVector::V_Constr(&xw, elementsNb, 0);
-    FvmVector::V_Constr(&xp, elementsNb, 0);
-    FvmVector::V_Constr(&xT, elementsNb, 0);
-    FvmVector::V_Constr(&xs, elementsNb, 0);
-
-    FvmVector::V_Constr(&xuf, facesNb, 1);
-    FvmVector::V_Constr(&xvf, facesNb, 1);
-    FvmVector::V_Constr(&xwf, facesNb, 1);
-    FvmVector::V_Constr(&xpf, facesNb, 1);
-    FvmVector::V_Constr(&xTf, facesNb, 1);
-    FvmVector::V_Constr(&xsf, facesNb, 1);
-
-    FvmVector::V_Constr(&ap, elementsNb, 0);
-    FvmVector::V_Constr(&hu, elementsNb, 0);
-    FvmVector::V_Constr(&hv, elementsNb, 0);
-    FvmVector::V_Constr(&hw, elementsNb, 0);
-
-    FvmVector::V_Constr(&temp1, elementsNb, 0);
-    FvmVector::V_Constr(&temp2, elementsNb, 0);
-
-    FvmVector::V_Constr(&xsm, elementsNb, 0);
-    FvmVector::V_Constr(&xsmf, facesNb, 0);
+
+    for (const auto &field: FIELDS) {
+        if (!IsActive(field.set))
+            continue;
+
+        if (field.layout == Layout::CELL)
+            FvmVector::V_Constr(&(this->*field.member), elementsNb, 0);
+        else if (field.layout == Layout::FACE)
+            FvmVector::V_ConstrFace(&(this->*field.member));
+    }
+
+    PrintMemoryReport();
 }
 
-void FvmVar::Deallocate() {
-    DESTROY_VEC(cex);
-    DESTROY_VEC(cey);
-    DESTROY_VEC(cez);
-    DESTROY_VEC(cexl);
-    DESTROY_VEC(ceyl);
-    DESTROY_VEC(cezl);
-
-    DESTROY_VEC(Co);
-    DESTROY_VEC(Col);
-
-    DESTROY_VEC(uf);
-
-    DESTROY_VEC(dens);
-    DESTROY_VEC(visc);
-    DESTROY_VEC(spheat);
-    DESTROY_VEC(thcond);
-    DESTROY_VEC(densl);
-    DESTROY_VEC(viscl);
-    DESTROY_VEC(spheatl);
-    DESTROY_VEC(thcondl);
-
-    DESTROY_VEC(xu0);
-    DESTROY_VEC(xv0);
-    DESTROY_VEC(xw0);
-    DESTROY_VEC(xp0);
-    DESTROY_VEC(xT0);
-    DESTROY_VEC(xs0);
-    DESTROY_VEC(xu0l);
-    DESTROY_VEC(xv0l);
-    DESTROY_VEC(xw0l);
-    DESTROY_VEC(xp0l);
-    DESTROY_VEC(xT0l);
-    DESTROY_VEC(xs0l);
-
-    DESTROY_VEC(xu);
-    DESTROY_VEC(xv);
-    DESTROY_VEC(xw);
-    DESTROY_VEC(xp);
-    DESTROY_VEC(xT);
-    DESTROY_VEC(xs);
-    DESTROY_VEC(xul);
-    DESTROY_VEC(xvl);
-    DESTROY_VEC(xwl);
-    DESTROY_VEC(xpl);
-    DESTROY_VEC(xTl);
-    DESTROY_VEC(xsl);
-
-    DESTROY_VEC(xuf);
-    DESTROY_VEC(xvf);
-    DESTROY_VEC(xwf);
-    DESTROY_VEC(xpf);
-    DESTROY_VEC(xTf);
-    DESTROY_VEC(xsf);
-
-    DESTROY_VEC(bu);
-    DESTROY_VEC(bv);
-    DESTROY_VEC(bw);
-    DESTROY_VEC(bp);
-    DESTROY_VEC(bT);
-    DESTROY_VEC(bs);
-
-    DESTROY_VEC(hu);
-    DESTROY_VEC(hv);
-    DESTROY_VEC(hw);
-    DESTROY_VEC(hul);
-    DESTROY_VEC(hvl);
-    DESTROY_VEC(hwl);
-
-    DESTROY_VEC(ap);
-    DESTROY_VEC(apl);
-
-    DESTROY_VEC(xpp);
-    DESTROY_VEC(xTp);
-
-    DESTROY_VEC(betaf);
-
-    DESTROY_VEC(temp1);
-    DESTROY_VEC(temp2);
-
-    DESTROY_VEC(xsm);
-    DESTROY_VEC(xsml);
-    DESTROY_VEC(xsmf);
-
-    // Mats
+FvmVar::~FvmVar() {
+    for (const auto &field: FIELDS) {
+        Vec &v = this->*field.member;
+        if (field.layout == Layout::FACE && v != nullptr)
+            FvmVector::V_DestroyFace(&v);
+        DESTROY_VEC(v);
+    }
+
     DESTROY_MAT(Am);
     DESTROY_MAT(Ac);
     DESTROY_MAT(Ae);
     DESTROY_MAT(As);
 }
+
+bool FvmVar::IsActive(const FieldSet set) const {
+    const auto &calc = fvmParameter.calc;
+    switch (set) {
+        case FieldSet::FLOW:
+            return calc[ToInt(FieldIndex::U)] || calc[ToInt(FieldIndex::V)] ||
+                   calc[ToInt(FieldIndex::W)] || calc[ToInt(FieldIndex::P)];
+        case FieldSet::ENERGY:
+            return calc[ToInt(FieldIndex::T)];
+        case FieldSet::VOF:
+            return calc[ToInt(FieldIndex::S)];
+        case FieldSet::COURANT:
+            return fvmParameter.steady != LOGICAL_TRUE && fvmParameter.adjdt == LOGICAL_TRUE;
+        default:
+            return true;
+    }
+}
+
+bool FvmVar::Has(const std::string &name) const {
+    const FieldInfo *field = FindField(name);
+    return field && this->*field->member != nullptr;
+}
+
+Vec FvmVar::Get(const std::string &name) const {
+    const FieldInfo *field = FindField(name);
+    if (!field)
+        throw FvmException("Unknown field: " + name, LOGICAL_ERROR);
+
+    if (this->*field->member == nullptr)
+        throw FvmException("Field not allocated for the active equations: " + name, LOGICAL_ERROR);
+
+    return this->*field->member;
+}
+
+std::size_t FvmVar::MemoryBytes() const {
+    std::size_t bytes = 0;
+    for (const auto &field: FIELDS)
+        bytes += VecBytes(this->*field.member);
+    return bytes;
+}
+
+void FvmVar::PrintMemoryReport() const {
+    int allocated = 0;
+    for (const auto &field: FIELDS) {
+        const Vec v = this->*field.member;
+        if (v == nullptr)
+            continue;
+
+        ++allocated;
+        if (verbose) {
+            PetscPrintf(PETSC_COMM_WORLD, "  %-8s \t%.2f MB\n", field.name, VecBytes(v) / 1048576.0);
+        }
+    }
+
+    PetscPrintf(PETSC_COMM_WORLD, "Fields: %d of %d allocated, %.1f MB\n",
+                allocated, static_cast<int>(FIELDS.size()), MemoryBytes() / 1048576.0);
+}
@@ -1,60 +1,87 @@
 #ifndef FVMVARIABLES_HPP
 #define FVMVARIABLES_HPP
 
+#include <cstddef>
 #include <memory>
+#include <string>
 
 #include "petscksp.h"
 
 class FvmMeshContainer;
 
+/**
+ * Field registry of one simulation. Only the fields needed by the active
+ * equation set (fvmParameter.calc) are allocated; the others stay nullptr.
+ * Fields can be looked up by name, and every Vec/Mat is destroyed with
+ * the instance. The vectors use the layout and ghost exchanges of
+ * FvmVector, which are shared by the whole process and outlive it.
+ */
 class FvmVar {
 public:
+    //! Which equations need a field
+    enum class FieldSet {
+        ALWAYS, // geometry, velocity, pressure, flux and base properties
+        FLOW, // momentum/pressure solution (any of u, v, w, p solved)
+        ENERGY, // temperature (T solved)
+        VOF, // volume fraction (s solved)
+        COURANT // Courant number (transient runs with adjdt)
+    };
+
     explicit FvmVar(const std::shared_ptr<FvmMeshContainer> &fvmMesh);
 
-    ~FvmVar() = default;
+    ~FvmVar();
+
+    FvmVar(const FvmVar &) = delete;
+
+    FvmVar &operator=(const FvmVar &) = delete;
+
+    //! Whether the field set is allocated for the active equations
+    [[nodiscard]] bool IsActive(FieldSet set) const;
 
-    static void Deallocate();
+    [[nodiscard]] bool Has(const std::string &name) const;
 
-    static Vec cex, cey, cez; // Cell centers components
-    static Vec cexl, ceyl, cezl;
+    //! Allocated field by name (FvmException if unknown or not allocated)
+    [[nodiscard]] Vec Get(const std::string &name) const;
 
-    static Vec Co; // Courant number
-    static Vec Col;
+    [[nodiscard]] std::size_t MemoryBytes() const;
+
+    void PrintMemoryReport() const;
+
+public:
+    Vec cex = nullptr, cey = nullptr, cez = nullptr; // Cell centers components
 
-    static Vec uf; // Face flux velocity
+    Vec Co = nullptr; // Courant number
 
-    static Vec dens, spheat, thcond; // Density, Thermal conductivity, Specific heat
-    static Vec visc; // Dynamic viscosity
+    Vec uf = nullptr; // Face flux velocity
 
-    static Vec densl, viscl, spheatl, thcondl;
+    Vec dens = nullptr, spheat = nullptr, thcond = nullptr; // Density, Specific heat, Thermal conductivity
+    Vec visc = nullptr; // Dynamic viscosity
 
-    static Vec xu0, xv0, xw0, xp0, xT0, xs0; // Values at a cell centre (previous time step)
-    static Vec xu0l, xv0l, xw0l, xp0l, xT0l, xs0l;
+    Vec xu0 = nullptr, xv0 = nullptr, xw0 = nullptr; // Values at a cell centre (previous time step)
+    Vec xp0 = nullptr, xT0 = nullptr, xs0 = nullptr;
 
-    static Vec xu, xv, xw, xp, xT, xs; // Values at cell centres
-    static Vec xul, xvl, xwl, xpl, xTl, xsl;
+    Vec xu = nullptr, xv = nullptr, xw = nullptr; // Values at cell centres
+    Vec xp = nullptr, xT = nullptr, xs = nullptr;
 
-    static Vec xuf, xvf, xwf, xpf, xTf, xsf; // Values at face center
+    Vec xuf = nullptr, xvf = nullptr, xwf = nullptr; // Values at face center
+    Vec xpf = nullptr, xTf = nullptr, xsf = nullptr;
 
-    static Mat Am, Ac, Ae, As;
+    Mat Am = nullptr, Ac = nullptr, Ae = nullptr, As = nullptr;
 
-    static Vec bu, bv, bw, bp, bT, bs;
+    Vec bu = nullptr, bv = nullptr, bw = nullptr, bp = nullptr, bT = nullptr, bs = nullptr;
 
-    static Vec hu, hv, hw; // Momentum matrix source components without pressure
-    static Vec hul, hvl, hwl;
+    Vec hu = nullptr, hv = nullptr, hw = nullptr; // Momentum matrix source components without pressure
 
-    static Vec ap; // Momentum matrix diagonal
-    static Vec apl;
+    Vec ap = nullptr; // Momentum matrix diagonal
 
-    static Vec xpp, xTp;
+    Vec xpp = nullptr, xTp = nullptr;
 
-    static Vec betaf;
+    Vec betaf = nullptr;
 
-    static Vec temp1, temp2; // Temporary vectors
+    Vec temp1 = nullptr, temp2 = nullptr; // Temporary vectors
 
-    static Vec xsm; // Smoothed gamma at cell center
-    static Vec xsml;
-    static Vec xsmf; // Smoothed gamma  at face center
+    Vec xsm = nullptr; // Smoothed gamma at cell center
+    Vec xsmf = nullptr; // Smoothed gamma  at face center
 
 private:
     std::shared_ptr<FvmMeshContainer> _fvmMesh;
@@ -1,23 +1,21 @@
 #include "FvmVector.hpp"
 
+#include <algorithm>
+
 FvmVector *FvmVector::_instance = nullptr;
 
 FvmVector::FvmVector(const std::shared_ptr<FvmMeshContainer> &fvmMesh)
-    : _ghostsNb(fvmMesh->ghostsNb),
-      _ghostsVec(fvmMesh->ghosts) {
+    : _fvmMesh(fvmMesh.get()),
+      _elementsNb(fvmMesh->elementsNb),
+      _ghostsNb(fvmMesh->ghostsNb),
+      _ghostsVec(fvmMesh->ghosts),
+      _distributed(fvmMesh->IsDistributed()),
+      _facesNb(fvmMesh->facesNb),
+      _ownedFacesNb(fvmMesh->ownedFacesNb),
+      _faceGhosts(fvmMesh->faceGhosts) {
 }
 
 
-void FvmVector::V_SetCmp(const Vec *v, const int ind, const double value) {
-    VecSetValue(*v, ind, value, INSERT_VALUES);
-}
-
-double FvmVector::V_GetCmp(const Vec *v, const int ind) {
-    double value;
-    VecGetValues(*v, 1, &ind, &value);
-    return value;
-}
-
 void FvmVector::V_Constr(Vec *v, const int n, const int sequential) {
     if (sequential == 1) {
         VecCreateSeq(PETSC_COMM_SELF, n, v);
@@ -33,3 +31,88 @@ void FvmVector::V_Constr(Vec *v, const int n, const int sequential) {
 
     VecSetFromOptions(*v);
 }
+
+void FvmVector::V_ConstrFace(Vec *v) {
+    const auto &inst = FvmVector::Instance();
+    if (inst._distributed) {
+        VecCreateGhost(
+            PETSC_COMM_WORLD,
+            inst._ownedFacesNb,
+            PETSC_DECIDE,
+            static_cast<PetscInt>(inst._faceGhosts.size()),
+            inst._faceGhosts.data(), v);
+    } else {
+        VecCreateSeq(PETSC_COMM_SELF, inst._facesNb, v);
+    }
+
+    VecSetFromOptions(*v);
+    Instance()._faceFields.insert(*v);
+}
+
+void FvmVector::V_DestroyFace(Vec *v) {
+    if (_instance)
+        _instance->_faceFields.erase(*v);
+    VecDestroy(v);
+}
+
+FvmGhostExchange &FvmVector::AcquireExchange(const std::vector<Vec> &vecs) {
+    auto &pool = _ghostExchanges[static_cast<int>(vecs.size())];
+    for (const auto &exchange: pool) {
+        if (!exchange->InFlight())
+            return *exchange;
+    }
+
+    pool.push_back(std::make_unique<FvmGhostExchange>(_elementsNb, _ghostsVec, static_cast<int>(vecs.size())));
+    return *pool.back();
+}
+
+void FvmVector::V_GhostUpdate(const std::vector<Vec> &vecs) {
+    V_GhostUpdateBegin(vecs);
+    V_GhostUpdateEnd(vecs);
+}
+
+void FvmVector::V_GhostUpdateBegin(const std::vector<Vec> &vecs) {
+    if (vecs.empty())
+        return;
+    if (_instance && std::any_of(vecs.begin(), vecs.end(), [](const Vec v) {
+        return _instance->_faceFields.contains(v);
+    }))
+        throw std::runtime_error("Ghost update of a face field: shared faces hold the local orientation");
+    if (vecs.size() == 1) {
+        VecGhostUpdateBegin(vecs.front(), INSERT_VALUES, SCATTER_FORWARD);
+        return;
+    }
+
+    auto &inst = Instance();
+    if (inst._pendingExchanges.contains(vecs))
+        throw std::runtime_error("Ghost exchange begun twice without End");
+
+    FvmGhostExchange &exchange = inst.AcquireExchange(vecs);
+    exchange.Begin(vecs);
+    inst._pendingExchanges[vecs] = &exchange;
+}
+
+void FvmVector::V_GhostUpdateEnd(const std::vector<Vec> &vecs) {
+    if (vecs.empty())
+        return;
+    if (vecs.size() == 1) {
+        VecGhostUpdateEnd(vecs.front(), INSERT_VALUES, SCATTER_FORWARD);
+        return;
+    }
+
+    auto &inst = Instance();
+    const auto it = inst._pendingExchanges.find(vecs);
+    if (it == inst._pendingExchanges.end())
+        throw std::runtime_error("Ghost exchange ended without Begin");
+
+    FvmGhostExchange *exchange = it->second;
+    inst._pendingExchanges.erase(it);
+    exchange->End(vecs);
+}
+
+void FvmVector::V_DestroyGhostExchanges() {
+    if (_instance) {
+        _instance->_pendingExchanges.clear();
+        _instance->_ghostExchanges.clear();
+    }
+}
@@ -2,22 +2,40 @@
 #define FVMVECTOR_HPP
 
 #include "FvmMesh.hpp"
+#include "FvmGhostExchange.hpp"
 
+#include <map>
+#include <set>
 #include <vector>
 #include <memory>
+#include <stdexcept>
 
 
 #include "petscksp.h"
 
 
+/**
+ * Process-wide vector layout (cell ghosts, face ownership) and ghost
+ * exchanges of one mesh. Every FvmVar of the process is built on it, so
+ * one mesh is active at a time: Init rejects another mesh until Release
+ * has dropped the current one (after its last FvmVar is destroyed).
+ */
 class FvmVector {
 public:
     static void Init(const std::shared_ptr<FvmMeshContainer> &fvmMesh) {
         if (!_instance) {
             _instance = new FvmVector(fvmMesh);
+        } else if (_instance->_fvmMesh != fvmMesh.get()) {
+            throw std::runtime_error("FvmVector already initialized for another mesh. Call Release first.");
         }
     }
 
+    //! Drops the layout and exchanges of the current mesh; Init may then take another one
+    static void Release() {
+        delete _instance;
+        _instance = nullptr;
+    }
+
     static FvmVector &Instance() {
         if (!_instance) {
             throw std::runtime_error("FvmVector not initialized. Call Init first.");
@@ -27,19 +45,56 @@ public:
 
     static void V_Constr(Vec *v, int n, int sequential);
 
-    static void V_SetCmp(const Vec *v, int ind, double value);
+    /**
+     * Face field. On a distributed mesh the vector holds the owned faces
+     * and the shared processor-face copies as ghosts, so every local face
+     * index is addressable through a ghosted view; otherwise it is a
+     * sequential vector over all faces. Shared copies are written locally
+     * in the local orientation (fluxes have the opposite sign to the owner),
+     * so the ghost updates below reject face fields: a scatter would
+     * overwrite them with the owner's sign.
+     */
+    static void V_ConstrFace(Vec *v);
+
+    //! Destroys a face field made by V_ConstrFace
+    static void V_DestroyFace(Vec *v);
+
+    // Entry access goes through FieldView (FvmFieldView.hpp)
+
+    //! Updates the ghost values of cell vectors; several vectors go in one fused
+    //! exchange, a single vector through its own VecGhostUpdate. Throws for face fields.
+    static void V_GhostUpdate(const std::vector<Vec> &vecs);
 
-    // static void V_SetAllCmp(Vec *v, double value);
+    static void V_GhostUpdateBegin(const std::vector<Vec> &vecs);
 
-    static double V_GetCmp(const Vec *v, int ind);
+    static void V_GhostUpdateEnd(const std::vector<Vec> &vecs);
+
+    //! Releases the exchange buffers shared by all fields (after the last FvmVar, before PetscFinalize)
+    static void V_DestroyGhostExchanges();
 
 private:
     explicit FvmVector(const std::shared_ptr<FvmMeshContainer> &fvmMesh);
 
+    //! Idle pooled exchange for vecs.size() fields, created when all are in flight
+    FvmGhostExchange &AcquireExchange(const std::vector<Vec> &vecs);
+
 private:
+    const FvmMeshContainer *_fvmMesh = nullptr;
+
+    int _elementsNb = 0;
     int _ghostsNb = 0;
     std::vector<int> _ghostsVec;
 
+    bool _distributed = false;
+    int _facesNb = 0;
+    int _ownedFacesNb = 0;
+    std::vector<int> _faceGhosts;
+    std::set<Vec> _faceFields; //! Alive vectors of V_ConstrFace
+
+    //! Block buffers pooled by field count; a pool grows only while exchanges overlap
+    std::map<int, std::vector<std::unique_ptr<FvmGhostExchange> > > _ghostExchanges;
+    std::map<std::vector<Vec>, FvmGhostExchange *> _pendingExchanges; //! Begun and not yet ended
+
     static FvmVector *_instance;
 };
 
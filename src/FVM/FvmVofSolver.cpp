@@ -0,0 +1,378 @@
+#include "FvmVofSolver.hpp"
+#include "FvmMesh.hpp"
+#include "FvmVar.hpp"
+#include "FvmVector.hpp"
+#include "FvmFieldView.hpp"
+#include "FvmLog.hpp"
+#include "FvmParam.hpp"
+#include "FvmFlowFaces.hpp"
+#include "FvmFaceLoop.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FvmFlow;
+
+namespace {
+    constexpr int S = ToInt(FieldIndex::S);
+
+    /**
+     * CICSAM blending factor of one face: the face value is
+     * (1 - beta) donor + beta acceptor. gD, gA are the donor and acceptor
+     * values, gradD the donor gradient projected on d (acceptor minus
+     * donor centre), cosine the cosine between the donor gradient and d
+     * and courant the donor Courant number of the face.
+     */
+    double Beta(const double gD, const double gA, const double gradD, const double cosine, const double courant) {
+        // Upwind value extrapolated behind the donor
+        const double gU = LMIN(LMAX(gA - 2.0 * gradD, 0.0), 1.0);
+
+        const double range = gA - gU;
+        if (LABS(range) < SMALL)
+            return 0.0;
+
+        // Normalised donor value; upwind outside the bounded region
+        const double nD = (gD - gU) / range;
+        if (nD <= 0.0 || nD >= 1.0)
+            return 0.0;
+
+        const double c = LMAX(courant, SMALL);
+
+        const double hyperC = LMIN(nD / c, 1.0);
+        const double quickest = LMIN((8.0 * c * nD + (1.0 - c) * (6.0 * nD + 3.0)) / 8.0, hyperC);
+
+        // Hyper-C for an interface normal to the face, ULTIMATE-QUICKEST along it
+        const double cos2 = 2.0 * cosine * cosine - 1.0;
+        const double weight = LMIN(fvmParameter.kcicsam * (cos2 + 1.0) * 0.5, 1.0);
+
+        const double nF = weight * hyperC + (1.0 - weight) * quickest;
+
+        return LMIN(LMAX((nF - nD) / (1.0 - nD), 0.0), 1.0);
+    }
+}
+
+FvmVofSolver::FvmVofSolver(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar,
+                           const FvmSparsity &sparsity, const FvmGradient &gradient)
+    : _fvmMesh(fvmMesh),
+      _fvmVar(fvmVar),
+      _sparsity(sparsity),
+      _gradient(gradient) {
+    if (!_fvmVar->IsActive(FvmVar::FieldSet::VOF))
+        throw FvmException("VOF solver needs the volume fraction fields (fvmParameter.calc)", LOGICAL_ERROR);
+    if (fvmParameter.steady == LOGICAL_TRUE)
+        throw FvmException("VOF solver needs a transient run", LOGICAL_ERROR);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto elements = _fvmMesh->storage.Elements();
+
+    VecDuplicate(_fvmVar->xs, &_fvmVar->bs);
+    VecDuplicate(_fvmVar->uf, &_fvmVar->betaf);
+    for (auto &gradient: _gradS)
+        VecDuplicate(_fvmVar->xs, &gradient);
+
+    VecDuplicate(_fvmVar->xs, &_volume);
+    {
+        const FieldWrite volume(_volume);
+        for (int i = 0; i < elementsNb; ++i)
+            volume[i] = elements.Vp[i];
+    }
+    FvmVector::V_GhostUpdate({_volume});
+
+    _inverseAreaSum.assign(elementsNb, 0.0);
+    for (int i = 0; i < faces.size; ++i) {
+        _inverseAreaSum[faces.owner[i]] += faces.Aj[i];
+        if (faces.pair[i] != -1)
+            _inverseAreaSum[faces.pair[i]] += faces.Aj[i];
+    }
+    for (double &area: _inverseAreaSum)
+        area = 1.0 / LMAX(area, VSMALL);
+    _accumulator.resize(elementsNb);
+
+    _sparsity.CreateScalarMatrix(&_fvmVar->As);
+    _coefficients.resize(_sparsity.EntriesNumber());
+
+    _solver = std::make_unique<FvmLinearSolver>(FieldIndex::S, _fvmVar->As, _fvmMesh.get());
+}
+
+FvmVofSolver::~FvmVofSolver() {
+    for (auto &gradient: _gradS) {
+        if (gradient)
+            VecDestroy(&gradient);
+    }
+    if (_volume)
+        VecDestroy(&_volume);
+}
+
+void FvmVofSolver::Iterate(const double dt, std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter) {
+    PetscLogEventBegin(FvmLog::Event("FvmVofIterate"), 0, 0, 0, 0);
+
+    if (fvmParameter.vofcycles > 0) {
+        // Enough explicit sub-steps to hold the interface Courant number at maxCp
+        const double courant = ComputeCourant(dt);
+        const double maxCp = LMAX(static_cast<double>(fvmParameter.maxCp), SMALL);
+        const int cycles = LMAX(fvmParameter.vofcycles, static_cast<int>(std::ceil(courant / maxCp)));
+        const double dts = dt / cycles;
+
+        VecCopy(_fvmVar->xs0, _fvmVar->xs);
+
+        for (int k = 0; k < cycles; ++k)
+            Advance(dts);
+
+        // Relative change of the step
+        double change, norm;
+        VecWAXPY(_fvmVar->bs, -1.0, _fvmVar->xs0, _fvmVar->xs);
+        VecNorm(_fvmVar->bs, NORM_2, &change);
+        VecNorm(_fvmVar->xs, NORM_2, &norm);
+
+        fres[S] = change / LMAX(norm, SMALL);
+        fiter[S] = cycles;
+    } else {
+        // Blending factors follow the latest solution
+        fiter[S] = 0;
+        for (int k = 0; k <= LMAX(fvmParameter.ncicsamcor, 0); ++k) {
+            ComputeBeta(dt);
+            BuildMatrix(dt);
+
+            int iterations = 0;
+            const double residual = _solver->Solve(_fvmVar->bs, _fvmVar->xs, iterations);
+            if (k == 0)
+                fres[S] = residual;
+            fiter[S] += iterations;
+
+            Bound();
+        }
+    }
+
+    Smooth();
+
+    PetscLogEventEnd(FvmLog::Event("FvmVofIterate"), 0, 0, 0, 0);
+}
+
+double FvmVofSolver::ComputeCourant(const double dt) {
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto elements = _fvmMesh->storage.Elements();
+
+    double localMax = 0.0;
+    {
+        const GhostedFieldRead uf(_fvmVar->uf);
+
+        std::vector<double> &outflow = _accumulator;
+        std::fill(outflow.begin(), outflow.end(), 0.0);
+
+        // Volume leaving every cell over the step
+        for (int i = 0; i < faces.size; ++i) {
+            const double F = uf[i] * faces.Aj[i];
+            outflow[faces.owner[i]] += LMAX(F, 0.0);
+            if (faces.pair[i] != -1)
+                outflow[faces.pair[i]] += LMAX(-F, 0.0);
+        }
+
+        for (int i = 0; i < elementsNb; ++i)
+            localMax = LMAX(localMax, outflow[i] * dt / elements.Vp[i]);
+    }
+
+    double globalMax;
+    MPI_Allreduce(&localMax, &globalMax, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+
+    return globalMax;
+}
+
+void FvmVofSolver::ComputeBeta(const double dt) {
+    PetscLogEventBegin(FvmLog::Event("FvmVofBeta"), 0, 0, 0, 0);
+
+    // The ghosts of xs, stale after Bound or a new step, arrive during the gradient sweep
+    _gradient.Compute({{_fvmVar->xs, nullptr, nullptr, _gradS, true}});
+
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto stencil = _gradient.Stencil();
+
+    {
+        const GhostedFieldRead xs(_fvmVar->xs), volume(_volume), uf(_fvmVar->uf);
+        const GhostedFieldRead gx(_gradS[0]), gy(_gradS[1]), gz(_gradS[2]);
+        const GhostedFieldWrite betaf(_fvmVar->betaf);
+
+        for (int i = 0; i < faces.size; ++i) {
+            const int neighbour = stencil.neighbour[i];
+            if (neighbour == -1) {
+                betaf[i] = 0.0;
+                continue;
+            }
+
+            const double F = uf[i] * faces.Aj[i];
+
+            // Donor and acceptor follow the flux
+            const int owner = stencil.owner[i];
+            const int donor = F >= 0.0 ? owner : neighbour;
+            const int acceptor = F >= 0.0 ? neighbour : owner;
+            const double sign = F >= 0.0 ? 1.0 : -1.0;
+
+            const double dx = sign * stencil.dx[i], dy = sign * stencil.dy[i], dz = sign * stencil.dz[i];
+            const double gradD = gx[donor] * dx + gy[donor] * dy + gz[donor] * dz;
+            const double lengths = std::sqrt((gx[donor] * gx[donor] + gy[donor] * gy[donor] + gz[donor] * gz[donor]) *
+                                             (dx * dx + dy * dy + dz * dz));
+
+            betaf[i] = Beta(xs[donor], xs[acceptor], gradD, LABS(gradD) / LMAX(lengths, VSMALL),
+                            LABS(F) * dt / volume[donor]);
+        }
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmVofBeta"), 0, 0, 0, 0);
+}
+
+void FvmVofSolver::BuildMatrix(const double dt) {
+    PetscLogEventBegin(FvmLog::Event("FvmVofMatrix"), 0, 0, 0, 0);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto elements = _fvmMesh->storage.Elements();
+    const Mat As = _fvmVar->As;
+
+    // Diagonals accumulate in the first elementsNb COO entries
+    std::fill_n(_coefficients.begin(), elementsNb, 0.0);
+
+    {
+        const GhostedFieldRead uf(_fvmVar->uf), xsf(_fvmVar->xsf), betaf(_fvmVar->betaf);
+        const FieldRead xs0(_fvmVar->xs0);
+        const FieldWrite bs(_fvmVar->bs);
+
+        for (int i = 0; i < elementsNb; ++i) {
+            const double inertia = elements.Vp[i] / dt;
+            _coefficients[i] = inertia;
+            bs[i] = inertia * xs0[i];
+        }
+
+        for (int i = 0; i < faces.size; ++i) {
+            const int owner = faces.owner[i];
+            const int neighbour = Neighbour(faces, i);
+            const double F = uf[i] * faces.Aj[i];
+
+            if (neighbour != -1) {
+                // Face value wO owner + wN neighbour
+                const double wO = F >= 0.0 ? 1.0 - betaf[i] : betaf[i];
+                const double wN = 1.0 - wO;
+
+                _coefficients[owner] += F * wO;
+                _coefficients[_sparsity.OwnerEntry(i)] = F * wN;
+
+                if (neighbour < elementsNb) {
+                    _coefficients[neighbour] -= F * wN;
+                    _coefficients[_sparsity.NeighbourEntry(i)] = -F * wO;
+                }
+                continue;
+            }
+
+            // Outflow takes the cell value, inflow brings xsf
+            _coefficients[owner] += LMAX(F, 0.0);
+            bs[owner] -= LMIN(F, 0.0) * xsf[i];
+        }
+    }
+
+    _sparsity.SetValues(As, _coefficients);
+    _sparsity.CheckAssembly(As, "VOF matrix");
+    _solver->MatrixUpdated();
+
+    PetscLogEventEnd(FvmLog::Event("FvmVofMatrix"), 0, 0, 0, 0);
+}
+
+void FvmVofSolver::Advance(const double dt) {
+    ComputeBeta(dt);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto elements = _fvmMesh->storage.Elements();
+
+    {
+        const GhostedFieldRead uf(_fvmVar->uf), xsf(_fvmVar->xsf), betaf(_fvmVar->betaf);
+        const GhostedFieldWrite xs(_fvmVar->xs);
+
+        std::fill(_accumulator.begin(), _accumulator.end(), 0.0);
+
+        // Net volume of the phase leaving every cell
+        for (int i = 0; i < faces.size; ++i) {
+            const int owner = faces.owner[i];
+            const int neighbour = Neighbour(faces, i);
+            const double F = uf[i] * faces.Aj[i];
+
+            if (neighbour != -1) {
+                const double wO = F >= 0.0 ? 1.0 - betaf[i] : betaf[i];
+                const double flux = F * (wO * xs[owner] + (1.0 - wO) * xs[neighbour]);
+
+                _accumulator[owner] += flux;
+                if (neighbour < elementsNb)
+                    _accumulator[neighbour] -= flux;
+                continue;
+            }
+
+            _accumulator[owner] += F * (F >= 0.0 ? xs[owner] : xsf[i]);
+        }
+
+        for (int i = 0; i < elementsNb; ++i)
+            xs[i] -= dt / elements.Vp[i] * _accumulator[i];
+    }
+
+    Bound();
+}
+
+void FvmVofSolver::Bound() {
+    {
+        const FieldWrite xs(_fvmVar->xs);
+        for (int i = 0; i < xs.Size(); ++i)
+            xs[i] = LMIN(LMAX(xs[i], 0.0), 1.0);
+    }
+}
+
+void FvmVofSolver::Smooth() {
+    PetscLogEventBegin(FvmLog::Event("FvmVofSmooth"), 0, 0, 0, 0);
+
+    const int elementsNb = _fvmMesh->elementsNb;
+    const auto faces = _fvmMesh->storage.Faces();
+    const auto coefficients = _fvmMesh->faceCoefficients.View();
+
+    VecCopy(_fvmVar->xs, _fvmVar->xsm);
+
+    // Area weighted average of the face values around every cell; the ghosts of the
+    // previous pass arrive while the interior faces are summed
+    for (int pass = 0; pass < fvmParameter.smooth; ++pass) {
+        std::fill(_accumulator.begin(), _accumulator.end(), 0.0);
+        OverlappedFaceLoop(_fvmMesh->faceSplit, {_fvmVar->xsm}, [&](const std::span<const int> faceList) {
+            const GhostedFieldRead xsm(_fvmVar->xsm);
+
+            for (const int i: faceList) {
+                const int owner = faces.owner[i];
+                const int neighbour = Neighbour(faces, i);
+
+                const double value = neighbour != -1
+                                         ? xsm[owner] * (1.0 - coefficients.lambda[i]) +
+                                           xsm[neighbour] * coefficients.lambda[i]
+                                         : xsm[owner];
+
+                _accumulator[owner] += value * faces.Aj[i];
+                if (neighbour != -1 && neighbour < elementsNb)
+                    _accumulator[neighbour] += value * faces.Aj[i];
+            }
+        });
+
+        const FieldWrite xsm(_fvmVar->xsm);
+        for (int i = 0; i < elementsNb; ++i)
+            xsm[i] = _accumulator[i] * _inverseAreaSum[i];
+    }
+
+    // Bound left the ghosts of xs behind: one exchange for both fields
+    FvmVector::V_GhostUpdate({_fvmVar->xs, _fvmVar->xsm});
+
+    {
+        const GhostedFieldRead xsm(_fvmVar->xsm);
+        const GhostedFieldWrite xsmf(_fvmVar->xsmf);
+
+        for (int i = 0; i < faces.size; ++i) {
+            const int neighbour = Neighbour(faces, i);
+            xsmf[i] = neighbour != -1
+                          ? Interpolate(xsm, faces.owner[i], neighbour, coefficients.lambda[i])
+                          : xsm[faces.owner[i]];
+        }
+    }
+
+    PetscLogEventEnd(FvmLog::Event("FvmVofSmooth"), 0, 0, 0, 0);
+}
@@ -0,0 +1,87 @@
+#ifndef FVMVOFSOLVER_HPP
+#define FVMVOFSOLVER_HPP
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Globals.hpp"
+#include "FvmSparsity.hpp"
+#include "FvmLinearSolver.hpp"
+#include "FvmGradient.hpp"
+
+#include "petscksp.h"
+
+class FvmMeshContainer;
+class FvmVar;
+
+/**
+ * Volume fraction (xs) transport d(gamma)/dt + div(uf gamma) = 0 with the
+ * CICSAM face values of Ubbink and Issa: per face the donor value is
+ * blended towards the acceptor by betaf, switching between Hyper-C and
+ * ULTIMATE-QUICKEST by the angle between the interface normal and the
+ * face direction (weighted by fvmParameter.kcicsam).
+ *
+ * fvmParameter.vofcycles = 0 solves one implicit system per flow step,
+ * re-evaluating betaf fvmParameter.ncicsamcor times. With vofcycles > 0
+ * the step is split into explicit sub-steps, at least vofcycles and
+ * enough to keep the interface Courant number below fvmParameter.maxCp,
+ * so the pressure solve keeps the larger flow time step.
+ *
+ * Like FvmEnergySolver it borrows the cell pattern (As registers the COO
+ * list, prefix s_) and the gradient operator of the flow solver. After the
+ * transport, fvmParameter.smooth Laplacian passes give xsm and xsmf for
+ * surface tension.
+ */
+class FvmVofSolver {
+public:
+    FvmVofSolver(const std::shared_ptr<FvmMeshContainer> &fvmMesh, const std::shared_ptr<FvmVar> &fvmVar,
+                 const FvmSparsity &sparsity, const FvmGradient &gradient);
+
+    ~FvmVofSolver();
+
+    FvmVofSolver(const FvmVofSolver &) = delete;
+
+    FvmVofSolver &operator=(const FvmVofSolver &) = delete;
+
+    //! Advances xs from xs0 by dt on the current face fluxes; fres[S] gets
+    //! the residual (implicit) or the relative change (sub-cycled), fiter[S]
+    //! the linear iterations or the sub-steps
+    void Iterate(double dt, std::array<double, nPhi> &fres, std::array<int, nPhi> &fiter);
+
+private:
+    //! Largest dt sum_out(uf Aj) / Vp over all ranks
+    [[nodiscard]] double ComputeCourant(double dt);
+
+    //! CICSAM blending factors of the current xs into betaf; the ghosts of xs are
+    //! updated by its gradient sweep
+    void ComputeBeta(double dt);
+
+    void BuildMatrix(double dt);
+
+    //! One explicit sub-step of length dt
+    void Advance(double dt);
+
+    //! Clips xs to [0, 1]; its ghosts wait for the next ComputeBeta or Smooth
+    void Bound();
+
+    //! Laplacian smoothing of xs into xsm and xsmf; updates the ghosts of xs
+    void Smooth();
+
+private:
+    std::shared_ptr<FvmMeshContainer> _fvmMesh;
+    std::shared_ptr<FvmVar> _fvmVar;
+
+    const FvmSparsity &_sparsity;
+    const FvmGradient &_gradient;
+
+    std::unique_ptr<FvmLinearSolver> _solver;
+
+    std::vector<PetscScalar> _coefficients; //! COO values of As
+    std::array<Vec, 3> _gradS{}; //! Gradient of xs, ghosted like xs
+    Vec _volume = nullptr; //! Ghosted cell volumes (donor Courant numbers of processor faces)
+    std::vector<double> _inverseAreaSum; //! 1 / sum_f Aj per cell (smoothing)
+    std::vector<double> _accumulator; //! Per cell sums of the face loops
+};
+
+#endif